@@ -0,0 +1,111 @@
+#include <vector>
+
+#include "alias_sampler.h"
+
+AliasSampler::AliasSampler(void)
+{
+    n = 0;
+    sum = 0;
+}
+
+void AliasSampler::build(const double* weights, int n)
+{
+    int i = 0;
+
+    this->n = n;
+    sum = 0;
+
+    prob.resize(n);
+    alias.resize(n);
+    small.clear();
+    large.clear();
+
+    for(i=0; i<n; i++)
+    {
+        sum += weights[i];
+    }
+
+    /* Sans aucun poids, on tire uniformément. */
+    if(sum <= 0)
+    {
+        for(i=0; i<n; i++)
+        {
+            prob[i] = 1;
+            alias[i] = i;
+        }
+
+        return;
+    }
+
+    /* On normalise pour que la moyenne des poids soit de 1. */
+    double scale = n/sum;
+
+    for(i=0; i<n; i++)
+    {
+        prob[i] = weights[i]*scale;
+
+        if(prob[i] < 1)
+        {
+            small.push_back(i);
+        }
+        else
+        {
+            large.push_back(i);
+        }
+    }
+
+    /* Chaque colonne trop petite est complétée par une colonne trop grande. */
+    while(!small.empty() && !large.empty())
+    {
+        int less = small.back();
+        int more = large.back();
+        small.pop_back();
+
+        alias[less] = more;
+        prob[more] -= 1 - prob[less];
+
+        if(prob[more] < 1)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    /* Ce qui reste ne diffère de 1 que par des erreurs d'arrondi. */
+    while(!large.empty())
+    {
+        prob[large.back()] = 1;
+        alias[large.back()] = large.back();
+        large.pop_back();
+    }
+
+    while(!small.empty())
+    {
+        prob[small.back()] = 1;
+        alias[small.back()] = small.back();
+        small.pop_back();
+    }
+}
+
+void AliasSampler::build(const std::vector<double>& weights)
+{
+    build(weights.data(), int(weights.size()));
+}
+
+void AliasSampler::reserve(int n)
+{
+    prob.reserve(n);
+    alias.reserve(n);
+    small.reserve(n);
+    large.reserve(n);
+}
+
+int AliasSampler::size(void) const
+{
+    return n;
+}
+
+double AliasSampler::total(void) const
+{
+    return sum;
+}
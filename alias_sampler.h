@@ -0,0 +1,104 @@
+#ifndef ALIAS_SAMPLER_H_INCLUDED
+#define ALIAS_SAMPLER_H_INCLUDED
+
+#include <vector>
+#include <random>
+
+/**
+ * @file
+ */
+
+/**
+ * @brief
+ * Tirage aléatoire pondéré d'un indice par la méthode des alias (Walker/Vose).
+ *
+ * La table est construite en temps linéaire à partir des poids,
+ * puis chaque tirage coûte un seul nombre aléatoire et un accès mémoire,
+ * quel que soit le nombre de poids.
+ * Les vecteurs internes sont conservés entre deux constructions
+ * pour éviter les réallocations.
+ */
+
+class AliasSampler
+{
+public:
+
+    AliasSampler(void);
+
+    /**
+     * @brief
+     * Méthode qui construit la table des alias.
+     *
+     * Si tous les poids sont nuls, le tirage devient uniforme.
+     *
+     * @param weights   Les poids (positifs ou nuls) de chaque indice
+     * @param n         Le nombre de poids
+     */
+    void build(const double* weights, int n);
+
+    /**
+     * @brief
+     * Méthode qui construit la table des alias.
+     *
+     * @param weights   Les poids (positifs ou nuls) de chaque indice
+     */
+    void build(const std::vector<double>& weights);
+
+    /**
+     * @brief
+     * Méthode qui réserve la mémoire de la table, pour que les constructions
+     * suivantes n'allouent plus rien.
+     *
+     * @param n         Le plus grand nombre de poids attendu
+     */
+    void reserve(int n);
+
+    /**
+     * @brief
+     * Méthode qui tire un indice au hasard selon les poids.
+     *
+     * @param generator     Le générateur de nombres aléatoires
+     *
+     * @return              L'indice tiré, entre 0 et size() - 1
+     */
+    template <typename Generator>
+    int sample(Generator& generator) const
+    {
+        std::uniform_real_distribution<double> unif(0, n);
+
+        double u = unif(generator);
+        int col = int(u);
+
+        /* Protection contre l'arrondi de u vers n. */
+        if(col >= n)
+        {
+            col = n - 1;
+        }
+
+        if(u - col < prob[col])
+        {
+            return col;
+        }
+
+        return alias[col];
+    }
+
+    /** @brief Le nombre d'indices de la table */
+    int size(void) const;
+
+    /** @brief La somme des poids utilisés pour construire la table */
+    double total(void) const;
+
+private:
+
+    int n; /**< @brief Le nombre d'indices */
+    double sum; /**< @brief La somme des poids */
+
+    std::vector<double> prob; /**< @brief Probabilité de garder la colonne tirée */
+    std::vector<int> alias; /**< @brief L'indice à prendre sinon */
+
+    std::vector<int> small; /**< @brief Pile temporaire des colonnes sous la moyenne */
+    std::vector<int> large; /**< @brief Pile temporaire des colonnes au dessus de la moyenne */
+};
+
+#endif // ALIAS_SAMPLER_H_INCLUDED
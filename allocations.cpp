@@ -0,0 +1,98 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <atomic>
+
+#include "allocations.h"
+
+#ifdef PLANTS_COUNT_ALLOCATIONS
+
+namespace
+{
+    std::atomic<std::uint64_t> allocations(0);
+
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        void* p = nullptr;
+
+        allocations.fetch_add(1, std::memory_order_relaxed);
+
+        if(size == 0)
+        {
+            size = 1;
+        }
+
+        if(alignment <= alignof(std::max_align_t))
+        {
+            p = std::malloc(size);
+        }
+        else
+        {
+            /* aligned_alloc veut une taille multiple de l'alignement. */
+            p = std::aligned_alloc(alignment, (size + alignment - 1)/alignment*alignment);
+        }
+
+        if(!p)
+        {
+            throw std::bad_alloc();
+        }
+
+        return p;
+    }
+}
+
+/* Les autres formes (tableaux, nothrow, tailles) appellent celles-ci dans la bibliothèque standard. */
+void* operator new(std::size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, std::size_t(alignment));
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+bool allocationsAreCounted(void)
+{
+    return true;
+}
+
+std::uint64_t allocationCount(void)
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool allocationsAreCounted(void)
+{
+    return false;
+}
+
+std::uint64_t allocationCount(void)
+{
+    return 0;
+}
+
+#endif // PLANTS_COUNT_ALLOCATIONS
@@ -0,0 +1,23 @@
+#ifndef ALLOCATIONS_H_INCLUDED
+#define ALLOCATIONS_H_INCLUDED
+
+#include <cstdint>
+
+/**
+ * @file
+ *
+ * Compteur des allocations sur le tas.
+ *
+ * Compiler avec -DPLANTS_COUNT_ALLOCATIONS pour l'activer : les opérateurs new et delete
+ * globaux sont alors remplacés par des versions qui comptent chaque allocation.
+ * Le banc d'essai s'en sert pour vérifier qu'une génération n'alloue plus rien
+ * une fois les vecteurs de travail à leur taille.
+ */
+
+/** @brief Si les allocations sont comptées (programme compilé avec -DPLANTS_COUNT_ALLOCATIONS) */
+bool allocationsAreCounted(void);
+
+/** @brief Le nombre d'allocations sur le tas depuis le début du programme (toujours 0 si elles ne sont pas comptées) */
+std::uint64_t allocationCount(void);
+
+#endif // ALLOCATIONS_H_INCLUDED
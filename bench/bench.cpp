@@ -0,0 +1,632 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <cstdio>
+#include <algorithm>
+
+#include "../world.h"
+#include "../patch.h"
+#include "../population.h"
+#include "../alias_sampler.h"
+#include "../options.h"
+#include "../allocations.h"
+#include "../rng.h"
+
+/**
+ * @file
+ *
+ * Banc d'essai du modèle : mesures des étapes d'une génération et mesures de passage à l'échelle.
+ *
+ * Usage :
+ *      bench/build.sh
+ *      bench/bench [micro|scaling|all] [quick] [json=bench.json] [cle=valeur ...]
+ *
+ * Les réglages cle=valeur sont ceux du modèle (threads=4, band=2, hugepages=1...).
+ * Compilé avec -DPLANTS_COUNT_ALLOCATIONS (bench/build.sh -DPLANTS_COUNT_ALLOCATIONS),
+ * le passage à l'échelle donne aussi le nombre d'allocations sur le tas par génération.
+ * Les mondes utilisent le générateur choisi à la compilation (bench/build.sh -DPLANTS_RNG_XOSHIRO...) ;
+ * les mesures rng_* comparent tous les générateurs.
+ * Les résultats sont écrits en JSON dans le fichier json=... (bench.json par défaut),
+ * et résumés sur la sortie d'erreur. Les mondes créés pour les mesures écrivent leurs
+ * rapports dans le répertoire courant, sous les identifiants 990000 et suivants,
+ * puis ces fichiers sont effacés.
+ */
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    /** @brief L'identifiant du prochain monde de mesure */
+    int nextWorldId = 990000;
+
+    /** @brief Une ligne du fichier JSON, déjà mise en forme */
+    std::vector<std::string> microResults;
+    std::vector<std::string> scalingResults;
+
+    /**
+     * @brief
+     * Fonction qui répète une tâche jusqu'à dépasser une durée minimale.
+     *
+     * @param minSeconds    La durée minimale de la mesure
+     * @param task          La tâche à mesurer
+     *
+     * @return              La durée moyenne d'un appel, en nanosecondes
+     */
+    template <typename Task>
+    double timeCalls(double minSeconds, Task task)
+    {
+        long long calls = 0;
+        double elapsed = 0;
+
+        /* Un premier appel, hors mesure, pour chauffer les caches et les allocations. */
+        task();
+
+        Clock::time_point start = Clock::now();
+
+        while(calls < 3 || elapsed < minSeconds)
+        {
+            task();
+            calls++;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        return elapsed*1e9/calls;
+    }
+
+    /**
+     * @brief
+     * Fonction qui enregistre le résultat d'une mesure d'étape.
+     *
+     * @param name      Le nom de l'étape
+     * @param items     Le nombre d'éléments traités par appel (individus, paires, patchs...)
+     * @param unit      Le nom des éléments
+     * @param nsPerCall La durée moyenne d'un appel
+     */
+    void recordMicro(const std::string& name, double items, const std::string& unit, double nsPerCall)
+    {
+        std::ostringstream line;
+
+        line << "{\"name\": \"" << name << "\", \"items\": " << items << ", \"unit\": \"" << unit
+             << "\", \"ns_per_call\": " << nsPerCall << ", \"ns_per_item\": " << nsPerCall/items << "}";
+        microResults.push_back(line.str());
+
+        std::cerr << name << " : " << nsPerCall/items << " ns par " << unit << " (" << items << " par appel)" << std::endl;
+    }
+
+    /**
+     * @brief
+     * Fonction qui mesure un générateur de nombres aléatoires :
+     * le tirage d'un nombre, puis la création d'un flux (une par patch et par génération).
+     *
+     * @param name          Le nom du générateur
+     * @param minSeconds    La durée minimale de chaque mesure
+     */
+    template <typename Engine>
+    void timeEngine(const std::string& name, double minSeconds)
+    {
+        int i = 0;
+        std::uint64_t stream = 0;
+        volatile std::uint64_t sink = 0;
+
+        Engine engine = Engine::stream(42, 0);
+
+        double ns = timeCalls(minSeconds, [&]
+        {
+            std::uint64_t sum = 0;
+            for(i=0; i<1000; i++)
+            {
+                sum += engine();
+            }
+            sink = sink + sum;
+        });
+        recordMicro("rng_" + name, 1000, "nombre", ns);
+
+        ns = timeCalls(minSeconds, [&]
+        {
+            Engine patchEngine = Engine::stream(42, stream++);
+            sink = sink + patchEngine();
+        });
+        recordMicro("rng_stream_" + name, 1, "flux", ns);
+    }
+
+    /** @brief Mersenne Twister n'a pas de flux : il est créé comme randomStream le fait. */
+    struct MersenneStream : public std::mt19937_64
+    {
+        MersenneStream(std::uint64_t seed) : std::mt19937_64(seed) {}
+
+        static MersenneStream stream(std::uint64_t seed, std::uint64_t number)
+        {
+            return MersenneStream(mix64(seed + 0x9E3779B97F4A7C15ULL*(number + 1)));
+        }
+    };
+
+    /** @brief Fonction qui efface les fichiers écrits par un monde de mesure. */
+    void removeWorldFiles(int idWorld)
+    {
+        std::string id = std::to_string(idWorld);
+
+        std::remove(("report_" + id + ".txt").c_str());
+        std::remove(("report_" + id + ".bin").c_str());
+        std::remove(("logPoll_" + id + ".txt").c_str());
+        std::remove(("relation_" + id + ".txt").c_str());
+        std::remove(("checkpoint_" + id + ".bin").c_str());
+    }
+}
+
+/**
+ * @brief
+ * Accède aux étapes privées d'une génération pour les mesurer séparément
+ * (World la déclare amie).
+ */
+
+class WorldBench
+{
+public:
+
+    /**
+     * @brief
+     * Méthode qui construit un monde homogène (même K et même P partout).
+     *
+     * @param NPatch        Le nombre de patchs
+     * @param K             La capacité d'accueil de chaque patch
+     * @param relatedness   Si l'apparentement est géré
+     * @param shift         Si l'aire de répartition se déplace (toutes les 10 générations)
+     * @param NGen          Le nombre de générations
+     * @param options       Les réglages facultatifs
+     */
+    static std::unique_ptr<World> make(int NPatch, int K, bool relatedness, bool shift, int NGen, const Options& options)
+    {
+        Options worldOptions = options;
+        worldOptions.progress = false;
+        worldOptions.checkpointFrequency = 0;
+        worldOptions.resume = false;
+
+        /* La convergence est suivie mais ne peut pas être atteinte (NPatchToConverge > NPatch). */
+        return std::unique_ptr<World>(new World(nextWorldId++, NPatch, 0.9, 0.1, relatedness, 0.01, shift, 10,
+                                                0, 0.05, 0.2, 0.5, 0, K, K, 3, 0, 0.9, 0.9, 3, 0.5, 0.3,
+                                                true, NPatch + 1, 100, 0.05, 0.01, 10, NGen, NGen, false,
+                                                worldOptions));
+    }
+
+    /** @brief Méthode qui détruit un monde de mesure et efface ses fichiers. */
+    static void destroy(std::unique_ptr<World>& world)
+    {
+        int idWorld = world->idWorld;
+
+        world.reset();
+        removeWorldFiles(idWorld);
+    }
+
+    /** @brief Le nombre total d'individus du monde */
+    static int size(const World& world)
+    {
+        return world.firstOfPatch.back();
+    }
+
+    static void pollinate(World& world)
+    {
+        for(Patch& patch : world.patches)
+        {
+            patch.pollenized = world.redefinePollination(patch.p);
+        }
+    }
+
+    static void createNextGeneration(World& world)
+    {
+        world.createNextGeneration();
+    }
+
+    /**
+     * @brief
+     * Méthode qui reproduit le tirage des mères de createNextGen pour un patch :
+     * rassemblement des patchs sources (table des alias résidente), puis K tirages.
+     */
+    static int sampleMothers(World& world, int idPatch, RandomEngine& generator)
+    {
+        int i = 0;
+        int sum = 0;
+
+        world.gatherSeedSources(idPatch, 0);
+
+        for(i=0; i<world.patches[idPatch].K; i++)
+        {
+            int patchMother = 0;
+
+            sum += world.sampleSeed(world.scratch[0].sources, generator, patchMother) + patchMother;
+        }
+
+        return sum;
+    }
+
+    static void updateDispSeeds(World& world)
+    {
+        int i = 0;
+
+        for(i=0; i<world.NPatch; i++)
+        {
+            world.patches[i].updateDispSeeds(world.populationOf(i), world.delta, world.c);
+        }
+    }
+
+    static void mutation(World& world, Population& pop, RandomEngine& generator)
+    {
+        double sumS = 0, sumD = 0;
+
+        world.mutation(pop, 0, generator, sumS, sumD);
+    }
+
+    /** @brief Méthode qui garde les parents tirés lors de la dernière génération. */
+    static void saveParents(const World& world, std::vector<int>& mothers, std::vector<int>& fathers)
+    {
+        mothers = world.mothers;
+        fathers = world.fathers;
+    }
+
+    /** @brief Méthode qui remet les parents gardés, puis recalcule les apparentements. */
+    static void calcNewRelatednesses(World& world, const std::vector<int>& mothers, const std::vector<int>& fathers)
+    {
+        world.mothers.assign(mothers.begin(), mothers.end());
+        world.fathers.assign(fathers.begin(), fathers.end());
+        world.calcNewRelatednesses();
+    }
+
+    /**
+     * @brief
+     * Méthode qui vérifie la convergence de tous les patchs.
+     * Les moyennes sont toujours jugées semblables : chaque vérification compare
+     * la nouvelle moyenne à toute la fenêtre, et le suivi repart de zéro dès qu'il a convergé.
+     */
+    static int checkConvergence(World& world)
+    {
+        int sum = 0;
+
+        for(Patch& patch : world.patches)
+        {
+            if(patch.dConvergence.converged())
+            {
+                patch.dConvergence.reset(world.NGenToConverge);
+                patch.sConvergence.reset(world.NGenToConverge);
+            }
+
+            sum += patch.check_convergence(1e9, 1e9);
+        }
+
+        return sum;
+    }
+
+    static void writeReport(World& world)
+    {
+        world.writeReport();
+    }
+
+    static bool run(World& world)
+    {
+        return world.run(world.idWorld);
+    }
+};
+
+namespace
+{
+    /** @brief Les mesures des étapes d'une génération */
+    void runMicro(const Options& options, double minSeconds)
+    {
+        int i = 0;
+        int K = 1000;
+        volatile int sink = 0;
+
+        RandomEngine generator(42);
+
+        /* Générateurs de nombres aléatoires (le modèle utilise celui choisi à la compilation) */
+        timeEngine<MersenneStream>("mt19937_64", minSeconds);
+        timeEngine<Xoshiro256pp>("xoshiro256pp", minSeconds);
+        timeEngine<Pcg64>("pcg64", minSeconds);
+        timeEngine<Philox4x32>("philox4x32", minSeconds);
+
+        /* Pressions d'un patch */
+        {
+            Patch patch(0.9, K, 0);
+            Population pop;
+            std::vector<double> press;
+            patch.pollenized = true;
+            press.reserve(4*K);
+
+            for(i=0; i<K; i++)
+            {
+                pop.emplace_back(0.5, 0.3, 0);
+            }
+
+            double ns = timeCalls(minSeconds, [&]
+            {
+                patch.updateDispSeeds(pop, 0.9, 0.1);
+            });
+            recordMicro("patch_disp_press", K, "individu", ns);
+
+            ns = timeCalls(minSeconds, [&]
+            {
+                press.clear();
+                patch.getResidPress(pop, 0.9, press);
+            });
+            recordMicro("patch_resid_press", K, "individu", ns);
+        }
+
+        /* Étapes d'un monde sans apparentement */
+        {
+            std::unique_ptr<World> world = WorldBench::make(20, 200, false, false, 1000000, options);
+            int Ktot = WorldBench::size(*world);
+
+            WorldBench::pollinate(*world);
+            WorldBench::updateDispSeeds(*world);
+
+            double ns = timeCalls(minSeconds, [&]
+            {
+                sink = sink + WorldBench::sampleMothers(*world, 10, generator);
+            });
+            recordMicro("mother_sampling", 200, "descendant", ns);
+
+            Population pop;
+            for(i=0; i<K; i++)
+            {
+                pop.emplace_back(0.5, 0.3, 0);
+            }
+            ns = timeCalls(minSeconds, [&]
+            {
+                WorldBench::mutation(*world, pop, generator);
+            });
+            recordMicro("mutation", K, "individu", ns);
+
+            ns = timeCalls(minSeconds, [&]
+            {
+                WorldBench::pollinate(*world);
+                WorldBench::createNextGeneration(*world);
+            });
+            recordMicro("create_next_generation", Ktot, "individu", ns);
+
+            ns = timeCalls(minSeconds, [&]
+            {
+                sink = sink + WorldBench::checkConvergence(*world);
+            });
+            recordMicro("check_convergence", 20, "patch", ns);
+
+            ns = timeCalls(minSeconds, [&]
+            {
+                WorldBench::writeReport(*world);
+            });
+            recordMicro("write_report", Ktot, "individu", ns);
+
+            WorldBench::destroy(world);
+        }
+
+        /* Tirage des mères selon la portée de la dispersion : le coût par descendant doit rester presque constant. */
+        for(int range : {1, 4, 16, 64})
+        {
+            Options kernelOptions = options;
+            kernelOptions.width = 0;
+            kernelOptions.kernel = exponentialKernel;
+            kernelOptions.kernelScale = 0.5*range;
+            kernelOptions.kernelRange = range;
+
+            std::unique_ptr<World> world = WorldBench::make(200, 100, false, false, 1000000, kernelOptions);
+
+            WorldBench::pollinate(*world);
+            WorldBench::updateDispSeeds(*world);
+
+            double ns = timeCalls(minSeconds, [&]
+            {
+                sink = sink + WorldBench::sampleMothers(*world, 100, generator);
+            });
+            recordMicro("mother_sampling_range_" + std::to_string(range), 100, "descendant", ns);
+
+            WorldBench::destroy(world);
+        }
+
+        /* Apparentements (en bande si band=D est donné) */
+        {
+            std::unique_ptr<World> world = WorldBench::make(10, 100, true, false, 1000000, options);
+            double Ktot = WorldBench::size(*world);
+            std::vector<int> mothers, fathers;
+
+            WorldBench::pollinate(*world);
+            WorldBench::createNextGeneration(*world);
+            WorldBench::saveParents(*world, mothers, fathers);
+
+            double ns = timeCalls(minSeconds, [&]
+            {
+                WorldBench::calcNewRelatednesses(*world, mothers, fathers);
+            });
+            recordMicro("calc_new_relatednesses", Ktot*(Ktot + 1)/2, "paire", ns);
+
+            WorldBench::destroy(world);
+        }
+    }
+
+    /**
+     * @brief
+     * Fonction qui mesure un monde complet, lancé deux fois (NGen et 2·NGen générations).
+     * La différence des deux durées ne garde que le coût des générations :
+     * la construction du monde et l'écriture finale des apparentements s'annulent.
+     */
+    void runScalingPoint(int NPatch, int width, int neighbours, int K, bool relatedness, bool shift, int NGen,
+                         const Options& options)
+    {
+        double seconds[2];
+        std::uint64_t allocations[2];
+        int run = 0;
+        int Ktot = 0;
+
+        Options worldOptions = options;
+        worldOptions.width = width;
+        worldOptions.neighbours = neighbours;
+
+        for(run=0; run<2; run++)
+        {
+            Clock::time_point start = Clock::now();
+
+            std::unique_ptr<World> world = WorldBench::make(NPatch, K, relatedness, shift, (run + 1)*NGen, worldOptions);
+            Ktot = WorldBench::size(*world);
+
+            /* Seules les allocations de la simulation sont comptées, pas celles de la construction. */
+            allocations[run] = allocationCount();
+            WorldBench::run(*world);
+            allocations[run] = allocationCount() - allocations[run];
+
+            WorldBench::destroy(world);
+
+            seconds[run] = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        double perGen = (seconds[1] - seconds[0])/NGen;
+
+        /* Les allocations des premières générations (vecteurs qui atteignent leur taille) s'annulent aussi. */
+        double allocationsPerGen = (double(allocations[1]) - double(allocations[0]))/NGen;
+        std::ostringstream line;
+
+        line << "{\"NPatch\": " << NPatch << ", \"width\": " << width << ", \"neighbours\": " << neighbours
+             << ", \"K\": " << K << ", \"Ktot\": " << Ktot
+             << ", \"relatedness\": " << (relatedness ? "true" : "false")
+             << ", \"shift\": " << (shift ? "true" : "false")
+             << ", \"generations\": " << NGen << ", \"seconds\": [" << seconds[0] << ", " << seconds[1] << "]"
+             << ", \"generations_per_second\": " << 1/perGen
+             << ", \"ns_per_individual\": " << perGen*1e9/Ktot;
+        if(allocationsAreCounted())
+        {
+            line << ", \"allocations_per_generation\": " << allocationsPerGen;
+        }
+        line << "}";
+        scalingResults.push_back(line.str());
+
+        std::cerr << "NPatch=" << NPatch;
+        if(width > 0)
+        {
+            std::cerr << " (" << width << "x" << NPatch/width << ", " << neighbours << " voisins)";
+        }
+        std::cerr << " K=" << K << " apparentement=" << relatedness << " shift=" << shift
+                  << " : " << 1/perGen << " générations/s, " << perGen*1e9/Ktot << " ns par individu";
+        if(allocationsAreCounted())
+        {
+            std::cerr << ", " << allocationsPerGen << " allocations par génération";
+        }
+        std::cerr << std::endl;
+    }
+
+    /**
+     * @brief
+     * Les mesures de passage à l'échelle : NPatch × K × {apparentement} × {shift} sur une chaîne,
+     * puis des grilles de 100×100 patchs (4 et 8 voisins, sans apparentement).
+     */
+    void runScaling(const Options& options, bool quick)
+    {
+        std::vector<int> NPatches = {10, 40};
+        std::vector<int> Ks = {25, 100};
+
+        /* Nombre d'individus × générations (ou de paires × générations avec l'apparentement) visé par mesure */
+        double work = quick ? 1e6 : 1e7;
+        double pairWork = quick ? 1e8 : 1e9;
+
+        for(int NPatch : NPatches)
+        {
+            for(int K : Ks)
+            {
+                for(int relatedness=0; relatedness<2; relatedness++)
+                {
+                    for(int shift=0; shift<2; shift++)
+                    {
+                        double Ktot = double(NPatch)*K;
+                        double gens = relatedness ? pairWork/(Ktot*Ktot/2) : work/Ktot;
+
+                        runScalingPoint(NPatch, 0, 4, K, relatedness, shift, std::max(20, int(gens)), options);
+                    }
+                }
+            }
+        }
+
+        for(int neighbours : {4, 8})
+        {
+            for(int shift=0; shift<2; shift++)
+            {
+                runScalingPoint(10000, 100, neighbours, 10, false, shift, std::max(20, int(work/1e5)), options);
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int i = 0;
+    bool micro = true, scaling = true, quick = false;
+    std::string jsonPath = "bench.json";
+
+    Options options;
+    options.seedIsSet = true;
+    options.seed = 42;
+
+    for(i=1; i<argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if(arg == "micro" || arg == "scaling")
+        {
+            micro = (arg == "micro");
+            scaling = (arg == "scaling");
+        }
+        else if(arg == "all")
+        {
+            micro = true;
+            scaling = true;
+        }
+        else if(arg == "quick")
+        {
+            quick = true;
+        }
+        else if(arg.compare(0, 5, "json=") == 0)
+        {
+            jsonPath = arg.substr(5);
+        }
+        else if(!options.parse(arg))
+        {
+            std::cerr << "Usage : " << argv[0] << " [micro|scaling|all] [quick] [json=bench.json] [cle=valeur ...]" << std::endl;
+            return 1;
+        }
+    }
+
+    if(micro)
+    {
+        runMicro(options, quick ? 0.05 : 0.5);
+    }
+
+    if(scaling)
+    {
+        runScaling(options, quick);
+    }
+
+    std::ofstream json(jsonPath);
+
+    json << "{\n  \"threads\": " << options.threads << ", \"band\": " << options.relatednessBand
+         << ", \"rng\": \"" << randomEngineName() << "\",\n";
+    json << "  \"micro\": [";
+    for(i=0; i<int(microResults.size()); i++)
+    {
+        json << (i ? ",\n    " : "\n    ") << microResults[i];
+    }
+    json << "\n  ],\n  \"scaling\": [";
+    for(i=0; i<int(scalingResults.size()); i++)
+    {
+        json << (i ? ",\n    " : "\n    ") << scalingResults[i];
+    }
+    json << "\n  ]\n}\n";
+
+    if(!json)
+    {
+        std::cerr << "Impossible d'écrire " << jsonPath << std::endl;
+        return 1;
+    }
+
+    std::cerr << "Résultats écrits dans " << jsonPath << std::endl;
+
+    return 0;
+}
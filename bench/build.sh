@@ -0,0 +1,8 @@
+#!/bin/bash
+# Compile le banc d'essai dans bench/bench, avec les sources du modèle (sauf main.cpp).
+# Les options supplémentaires sont passées à g++ : bench/build.sh -march=native
+cd "$(dirname "$0")/.." || exit 1
+
+sources=$(ls *.cpp | grep -v '^main\.cpp$')
+
+g++ -std=c++17 -O2 -pthread "$@" bench/bench.cpp ${sources} -o bench/bench
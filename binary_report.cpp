@@ -0,0 +1,536 @@
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+
+#include "binary_report.h"
+#include "population.h"
+
+namespace
+{
+    const char magicHeader[] = "PLRB";
+    const char magicBlock[] = "GNRT";
+    const char magicIndex[] = "INDX";
+    const char magicEnd[] = "PEND";
+
+    const std::uint32_t version = 1;
+
+    /* Ajoute la représentation mémoire d'une valeur à la fin d'un tampon. */
+    template <typename T>
+    void put(std::string& buffer, T value)
+    {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /* Lit une valeur à la position pos d'un tampon et avance pos. */
+    template <typename T>
+    bool get(const std::string& buffer, size_t& pos, T& value)
+    {
+        if(pos + sizeof(T) > buffer.size())
+        {
+            return false;
+        }
+
+        std::memcpy(&value, buffer.data() + pos, sizeof(T));
+        pos += sizeof(T);
+
+        return true;
+    }
+
+    template <typename T>
+    bool get(std::istream& in, T& value)
+    {
+        return bool(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    void putVarint(std::string& buffer, std::uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            buffer.push_back(char((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+
+        buffer.push_back(char(value));
+    }
+
+    bool getVarint(const std::string& buffer, size_t& pos, std::uint64_t& value)
+    {
+        int shift = 0;
+
+        value = 0;
+
+        while(pos < buffer.size() && shift < 64)
+        {
+            unsigned char byte = buffer[pos++];
+            value |= std::uint64_t(byte & 0x7F) << shift;
+
+            if(!(byte & 0x80))
+            {
+                return true;
+            }
+
+            shift += 7;
+        }
+
+        return false;
+    }
+
+    /* Le code entier d'une valeur : au millième ou bits du flottant. */
+    std::uint32_t encodeValue(double value, precisionReport precision)
+    {
+        if(precision == quantized)
+        {
+            return std::uint16_t(std::round(value*1000));
+        }
+
+        float single = float(value);
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &single, sizeof(bits));
+
+        return bits;
+    }
+
+    double decodeValue(std::uint32_t code, precisionReport precision)
+    {
+        if(precision == quantized)
+        {
+            return code/1000.0;
+        }
+
+        float single = 0;
+        std::memcpy(&single, &code, sizeof(single));
+
+        return single;
+    }
+}
+
+BinaryReport::BinaryReport(void)
+{
+    precision = quantized;
+    compressed = false;
+}
+
+BinaryReport::~BinaryReport()
+{
+    close();
+}
+
+void BinaryReport::open(const std::string& path, precisionReport precision, bool compressed)
+{
+    this->precision = precision;
+    this->compressed = compressed;
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+}
+
+void BinaryReport::writeHeader(const std::string& header)
+{
+    buffer.clear();
+    buffer.append(magicHeader, 4);
+    put<std::uint32_t>(buffer, version);
+    put<std::uint32_t>(buffer, precision);
+    put<std::uint32_t>(buffer, compressed);
+    put<std::uint32_t>(buffer, header.size());
+    buffer.append(header);
+
+    file.write(buffer.data(), buffer.size());
+}
+
+void BinaryReport::reopen(const std::string& path, precisionReport precision, bool compressed,
+                          const std::vector<int>& gens, const std::vector<std::uint64_t>& offsets)
+{
+    this->precision = precision;
+    this->compressed = compressed;
+
+    indexGen = gens;
+    indexOffset = offsets;
+
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(0, std::ios::end);
+}
+
+bool BinaryReport::is_open(void) const
+{
+    return file.is_open();
+}
+
+std::uint64_t BinaryReport::position(void)
+{
+    file.flush();
+
+    return file.tellp();
+}
+
+const std::vector<int>& BinaryReport::generations(void) const
+{
+    return indexGen;
+}
+
+const std::vector<std::uint64_t>& BinaryReport::offsets(void) const
+{
+    return indexOffset;
+}
+
+void BinaryReport::beginGeneration(int gen)
+{
+    current.gen = gen;
+    current.patches.clear();
+    current.counts.clear();
+    current.s.clear();
+    current.d.clear();
+}
+
+void BinaryReport::addPatch(int idPatch, const Population& pop)
+{
+    addPatch(idPatch, pop.s.data(), pop.d.data(), pop.size());
+}
+
+void BinaryReport::addPatch(int idPatch, const double* s, const double* d, int n)
+{
+    current.patches.push_back(idPatch);
+    current.counts.push_back(n);
+    current.s.insert(current.s.end(), s, s + n);
+    current.d.insert(current.d.end(), d, d + n);
+}
+
+void BinaryReport::encodeColumn(const std::vector<double>& values)
+{
+    std::uint32_t previous = 0;
+
+    column.clear();
+
+    for(double value : values)
+    {
+        std::uint32_t code = encodeValue(value, precision);
+
+        if(compressed)
+        {
+            /* Les valeurs voisines se ressemblent : on stocke la différence, en zigzag. */
+            std::int64_t diff = std::int64_t(code) - std::int64_t(previous);
+            putVarint(column, (std::uint64_t(diff) << 1) ^ std::uint64_t(diff >> 63));
+            previous = code;
+        }
+        else if(precision == quantized)
+        {
+            put<std::uint16_t>(column, code);
+        }
+        else
+        {
+            put<std::uint32_t>(column, code);
+        }
+    }
+}
+
+void BinaryReport::endGeneration(void)
+{
+    int i = 0;
+
+    if(!file.is_open())
+    {
+        return;
+    }
+
+    buffer.clear();
+    put<std::int32_t>(buffer, current.gen);
+    put<std::uint32_t>(buffer, current.patches.size());
+    put<std::uint32_t>(buffer, current.s.size());
+
+    for(i=0; i<int(current.patches.size()); i++)
+    {
+        put<std::int32_t>(buffer, current.patches[i]);
+        put<std::uint32_t>(buffer, current.counts[i]);
+    }
+
+    encodeColumn(current.s);
+    put<std::uint64_t>(buffer, column.size());
+    buffer.append(column);
+
+    encodeColumn(current.d);
+    put<std::uint64_t>(buffer, column.size());
+    buffer.append(column);
+
+    indexGen.push_back(current.gen);
+    indexOffset.push_back(file.tellp());
+
+    file.write(magicBlock, 4);
+    std::uint64_t size = buffer.size();
+    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    file.write(buffer.data(), buffer.size());
+}
+
+void BinaryReport::close(void)
+{
+    int i = 0;
+
+    if(!file.is_open())
+    {
+        return;
+    }
+
+    std::uint64_t indexPosition = file.tellp();
+
+    buffer.clear();
+    buffer.append(magicIndex, 4);
+    put<std::uint32_t>(buffer, indexGen.size());
+
+    for(i=0; i<int(indexGen.size()); i++)
+    {
+        put<std::int32_t>(buffer, indexGen[i]);
+        put<std::uint64_t>(buffer, indexOffset[i]);
+    }
+
+    put<std::uint64_t>(buffer, indexPosition);
+    buffer.append(magicEnd, 4);
+
+    file.write(buffer.data(), buffer.size());
+    file.close();
+}
+
+BinaryReportReader::BinaryReportReader(void)
+{
+    precision = quantized;
+    compressed = false;
+}
+
+bool BinaryReportReader::open(const std::string& path)
+{
+    int i = 0;
+    char magic[4];
+    std::uint32_t fileVersion = 0, filePrecision = 0, fileCompressed = 0, headerSize = 0;
+
+    file.open(path, std::ios::binary);
+
+    if(!file.read(magic, 4) || std::memcmp(magic, magicHeader, 4) != 0 ||
+       !get(file, fileVersion) || fileVersion != version ||
+       !get(file, filePrecision) || !get(file, fileCompressed) || !get(file, headerSize))
+    {
+        return false;
+    }
+
+    precision = precisionReport(filePrecision);
+    compressed = fileCompressed;
+
+    headerText.resize(headerSize);
+    if(!file.read(&headerText[0], headerSize))
+    {
+        return false;
+    }
+
+    std::uint64_t first = file.tellg();
+
+    /* On cherche l'index à la fin du fichier. */
+    std::uint64_t indexPosition = 0;
+    std::uint32_t nGen = 0;
+
+    file.seekg(-12, std::ios::end);
+
+    if(get(file, indexPosition) && file.read(magic, 4) && std::memcmp(magic, magicEnd, 4) == 0 &&
+       file.seekg(indexPosition) && file.read(magic, 4) && std::memcmp(magic, magicIndex, 4) == 0 && get(file, nGen))
+    {
+        indexGen.resize(nGen);
+        indexOffset.resize(nGen);
+
+        for(i=0; i<int(nGen); i++)
+        {
+            std::int32_t gen = 0;
+            get(file, gen);
+            get(file, indexOffset[i]);
+            indexGen[i] = gen;
+        }
+
+        if(file)
+        {
+            return true;
+        }
+    }
+
+    /* Pas d'index : la simulation a été interrompue, on parcourt les blocs. */
+    file.clear();
+    scan(first);
+
+    return true;
+}
+
+void BinaryReportReader::scan(std::uint64_t first)
+{
+    char magic[4];
+    std::uint64_t size = 0;
+    std::int32_t gen = 0;
+
+    indexGen.clear();
+    indexOffset.clear();
+
+    file.seekg(first);
+
+    while(file.read(magic, 4) && std::memcmp(magic, magicBlock, 4) == 0 && get(file, size) && get(file, gen))
+    {
+        std::uint64_t position = first;
+
+        /* Un bloc tronqué n'est pas gardé. */
+        file.seekg(0, std::ios::end);
+        if(std::uint64_t(file.tellg()) < first + 12 + size)
+        {
+            break;
+        }
+
+        indexGen.push_back(gen);
+        indexOffset.push_back(position);
+
+        first += 12 + size;
+        file.seekg(first);
+    }
+
+    file.clear();
+}
+
+const std::string& BinaryReportReader::header(void) const
+{
+    return headerText;
+}
+
+const std::vector<int>& BinaryReportReader::generations(void) const
+{
+    return indexGen;
+}
+
+bool BinaryReportReader::decodeColumn(const std::string& data, int n, std::vector<double>& values)
+{
+    int i = 0;
+    size_t pos = 0;
+    std::uint32_t previous = 0;
+
+    values.resize(n);
+
+    for(i=0; i<n; i++)
+    {
+        std::uint32_t code = 0;
+
+        if(compressed)
+        {
+            std::uint64_t zigzag = 0;
+
+            if(!getVarint(data, pos, zigzag))
+            {
+                return false;
+            }
+
+            std::int64_t diff = std::int64_t(zigzag >> 1) ^ -std::int64_t(zigzag & 1);
+            code = std::uint32_t(std::int64_t(previous) + diff);
+            previous = code;
+        }
+        else if(precision == quantized)
+        {
+            std::uint16_t value = 0;
+
+            if(!get(data, pos, value))
+            {
+                return false;
+            }
+
+            code = value;
+        }
+        else if(!get(data, pos, code))
+        {
+            return false;
+        }
+
+        values[i] = decodeValue(code, precision);
+    }
+
+    return true;
+}
+
+bool BinaryReportReader::read(int gen, ReportGeneration& result)
+{
+    int i = 0;
+    char magic[4];
+    std::uint64_t size = 0;
+
+    for(i=0; i<int(indexGen.size()) && indexGen[i] != gen; i++);
+
+    if(i == int(indexGen.size()))
+    {
+        return false;
+    }
+
+    file.clear();
+    file.seekg(indexOffset[i]);
+
+    if(!file.read(magic, 4) || std::memcmp(magic, magicBlock, 4) != 0 || !get(file, size))
+    {
+        return false;
+    }
+
+    std::string block(size, '\0');
+    if(!file.read(&block[0], size))
+    {
+        return false;
+    }
+
+    size_t pos = 0;
+    std::int32_t blockGen = 0;
+    std::uint32_t nPatch = 0, nInd = 0;
+
+    if(!get(block, pos, blockGen) || !get(block, pos, nPatch) || !get(block, pos, nInd))
+    {
+        return false;
+    }
+
+    result.gen = blockGen;
+    result.patches.resize(nPatch);
+    result.counts.resize(nPatch);
+
+    for(i=0; i<int(nPatch); i++)
+    {
+        std::int32_t patch = 0;
+        std::uint32_t count = 0;
+
+        if(!get(block, pos, patch) || !get(block, pos, count))
+        {
+            return false;
+        }
+
+        result.patches[i] = patch;
+        result.counts[i] = count;
+    }
+
+    std::uint64_t columnSize = 0;
+
+    if(!get(block, pos, columnSize) || pos + columnSize > block.size() ||
+       !decodeColumn(block.substr(pos, columnSize), nInd, result.s))
+    {
+        return false;
+    }
+
+    pos += columnSize;
+
+    if(!get(block, pos, columnSize) || pos + columnSize > block.size() ||
+       !decodeColumn(block.substr(pos, columnSize), nInd, result.d))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void BinaryReportReader::writeText(const ReportGeneration& block, std::ostream& out)
+{
+    int i = 0, j = 0, k = 0;
+
+    for(i=0; i<int(block.patches.size()); i++)
+    {
+        for(j=0; j<block.counts[i]; j++)
+        {
+            out << block.gen << '\t';
+            out << block.patches[i] << '\t';
+            out << j << '\t';
+            out << std::round(block.s[k] * 1000) / 1000 << '\t';
+            out << std::round(block.d[k] * 1000) / 1000 << '\n';
+            k++;
+        }
+    }
+}
@@ -0,0 +1,242 @@
+#ifndef BINARY_REPORT_H_INCLUDED
+#define BINARY_REPORT_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "population.h"
+
+/**
+ * @file
+ *
+ * Format binaire du rapport (report_<id>.bin), en petit-boutiste :
+ *
+ * - Entête : "PLRB", version (uint32), précision (uint32), compression (uint32),
+ *   longueur de l'entête texte (uint32) puis l'entête texte du rapport habituel.
+ * - Un bloc par génération rapportée : "GNRT", taille du bloc (uint64), génération (int32),
+ *   nombre de patchs (uint32), nombre d'individus (uint32), puis pour chaque patch
+ *   son numéro et son nombre d'individus (int32, uint32), puis les colonnes s et d,
+ *   chacune précédée de sa taille en octets (uint64).
+ * - À la fermeture, un index : "INDX", nombre de générations (uint32), puis pour chacune
+ *   la génération (int32) et la position de son bloc (uint64) ; enfin la position
+ *   de l'index (uint64) et "PEND". Sans index (simulation interrompue),
+ *   le lecteur parcourt les blocs un par un.
+ */
+
+/** @brief Énumération qui permet de choisir comment les traits sont stockés dans le rapport binaire. */
+typedef enum _reportPrecision_
+{
+    quantized = 0,  /**< Entier sur 16 bits, au millième (identique au rapport texte). */
+    simple = 1,     /**< Flottant sur 32 bits. */
+} precisionReport;
+
+/** @brief Le contenu d'un bloc du rapport binaire. */
+typedef struct _ReportGeneration_
+{
+    int gen; /**< @brief La génération */
+    std::vector<int> patches; /**< @brief Le numéro de chaque patch rapporté */
+    std::vector<int> counts; /**< @brief Le nombre d'individus de chaque patch */
+    std::vector<double> s; /**< @brief Les taux d'autofécondation, patch par patch */
+    std::vector<double> d; /**< @brief Les taux de dispersion, patch par patch */
+} ReportGeneration;
+
+/**
+ * @brief
+ * Écrit le rapport d'un monde en colonnes binaires, une génération par bloc.
+ */
+
+class BinaryReport
+{
+public:
+
+    BinaryReport(void);
+
+    ~BinaryReport();
+
+    /**
+     * @brief
+     * Méthode qui crée le fichier.
+     *
+     * @param path          Le chemin du fichier
+     * @param precision     Le stockage des traits
+     * @param compressed    Si les colonnes sont compressées (différences successives en varint)
+     */
+    void open(const std::string& path, precisionReport precision, bool compressed);
+
+    /**
+     * @brief
+     * Méthode qui écrit l'entête du fichier, avant le premier bloc.
+     *
+     * @param header        L'entête texte du rapport habituel
+     */
+    void writeHeader(const std::string& header);
+
+    /**
+     * @brief
+     * Méthode qui rouvre un rapport pour continuer à y ajouter des blocs
+     * (reprise d'une simulation à partir d'un instantané).
+     *
+     * Le fichier doit déjà avoir été tronqué à la fin du dernier bloc gardé.
+     *
+     * @param path          Le chemin du fichier
+     * @param precision     Le stockage des traits
+     * @param compressed    Si les colonnes sont compressées
+     * @param gens          Les générations déjà écrites
+     * @param offsets       La position de leur bloc
+     */
+    void reopen(const std::string& path, precisionReport precision, bool compressed,
+                const std::vector<int>& gens, const std::vector<std::uint64_t>& offsets);
+
+    /** @brief Vrai si le fichier est ouvert */
+    bool is_open(void) const;
+
+    /** @brief La taille du fichier écrite jusqu'ici (les blocs en attente sont d'abord écrits sur le disque) */
+    std::uint64_t position(void);
+
+    /** @brief Les générations déjà écrites */
+    const std::vector<int>& generations(void) const;
+
+    /** @brief La position du bloc de chaque génération déjà écrite */
+    const std::vector<std::uint64_t>& offsets(void) const;
+
+    /**
+     * @brief
+     * Méthode qui commence le bloc d'une génération.
+     *
+     * @param gen   La génération
+     */
+    void beginGeneration(int gen);
+
+    /**
+     * @brief
+     * Méthode qui ajoute les individus d'un patch au bloc en cours.
+     *
+     * @param idPatch   Le numéro du patch
+     * @param pop       Les individus du patch
+     */
+    void addPatch(int idPatch, const Population& pop);
+
+    /**
+     * @brief
+     * Méthode qui ajoute les individus d'un patch au bloc en cours, à partir des traits seuls.
+     *
+     * @param idPatch   Le numéro du patch
+     * @param s         Les taux d'autofécondation des individus
+     * @param d         Les taux de dispersion des individus
+     * @param n         Le nombre d'individus
+     */
+    void addPatch(int idPatch, const double* s, const double* d, int n);
+
+    /** @brief Méthode qui écrit le bloc en cours. */
+    void endGeneration(void);
+
+    /** @brief Méthode qui écrit l'index des générations et ferme le fichier. */
+    void close(void);
+
+private:
+
+    std::ofstream file; /**< @brief Le fichier du rapport */
+
+    precisionReport precision; /**< @brief Le stockage des traits */
+    bool compressed; /**< @brief Si les colonnes sont compressées */
+
+    ReportGeneration current; /**< @brief Le bloc en cours */
+
+    std::vector<int> indexGen; /**< @brief Les générations déjà écrites */
+    std::vector<std::uint64_t> indexOffset; /**< @brief La position de leur bloc */
+
+    std::string buffer; /**< @brief Le bloc en cours, encodé */
+    std::string column; /**< @brief Une colonne encodée */
+
+    /**
+     * @brief
+     * Méthode qui encode une colonne de traits selon la précision et la compression.
+     *
+     * @param values    Les valeurs
+     */
+    void encodeColumn(const std::vector<double>& values);
+};
+
+/**
+ * @brief
+ * Lit un rapport binaire, génération par génération ou directement à une génération donnée.
+ */
+
+class BinaryReportReader
+{
+public:
+
+    BinaryReportReader(void);
+
+    /**
+     * @brief
+     * Méthode qui ouvre le fichier, lit l'entête et l'index.
+     *
+     * @param path  Le chemin du fichier
+     *
+     * @return      Vrai si le fichier est un rapport binaire valide
+     */
+    bool open(const std::string& path);
+
+    /** @brief L'entête texte du rapport habituel */
+    const std::string& header(void) const;
+
+    /** @brief Les générations présentes dans le fichier */
+    const std::vector<int>& generations(void) const;
+
+    /**
+     * @brief
+     * Méthode qui lit le bloc d'une génération.
+     *
+     * @param gen       La génération voulue
+     * @param result    Le bloc lu
+     *
+     * @return          Vrai si la génération existe
+     */
+    bool read(int gen, ReportGeneration& result);
+
+    /**
+     * @brief
+     * Méthode qui écrit un bloc au format du rapport texte habituel.
+     *
+     * @param block     Le bloc
+     * @param out       Le flux de sortie
+     */
+    static void writeText(const ReportGeneration& block, std::ostream& out);
+
+private:
+
+    std::ifstream file; /**< @brief Le fichier du rapport */
+
+    precisionReport precision; /**< @brief Le stockage des traits */
+    bool compressed; /**< @brief Si les colonnes sont compressées */
+
+    std::string headerText; /**< @brief L'entête texte */
+
+    std::vector<int> indexGen; /**< @brief Les générations */
+    std::vector<std::uint64_t> indexOffset; /**< @brief La position de leur bloc */
+
+    /**
+     * @brief
+     * Méthode qui reconstruit l'index en parcourant les blocs (fichier sans index).
+     *
+     * @param first     La position du premier bloc
+     */
+    void scan(std::uint64_t first);
+
+    /**
+     * @brief
+     * Méthode qui décode une colonne de traits.
+     *
+     * @param data      La colonne encodée
+     * @param n         Le nombre de valeurs
+     * @param values    Les valeurs décodées
+     *
+     * @return          Vrai si la colonne est valide
+     */
+    bool decodeColumn(const std::string& data, int n, std::vector<double>& values);
+};
+
+#endif // BINARY_REPORT_H_INCLUDED
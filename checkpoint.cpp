@@ -0,0 +1,140 @@
+#include <csignal>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+namespace
+{
+    const char magicCheckpoint[] = "PLCK";
+
+    const std::uint32_t version = 11;
+
+    volatile std::sig_atomic_t stopFlag = 0;
+
+    void onStopSignal(int sig)
+    {
+        stopFlag = 1;
+
+        /* Le prochain signal reprend son comportement habituel. */
+        std::signal(sig, SIG_DFL);
+    }
+
+    /* Force l'écriture sur le disque d'un fichier ou d'un dossier déjà fermé. */
+    bool syncPath(const std::string& path, int flags)
+    {
+        int fd = ::open(path.c_str(), flags);
+        bool synced = false;
+
+        if(fd < 0)
+        {
+            return false;
+        }
+
+        synced = fsync(fd) == 0;
+        ::close(fd);
+
+        return synced;
+    }
+}
+
+bool CheckpointWriter::open(const std::string& path)
+{
+    this->path = path;
+
+    file.open(path + ".tmp", std::ios::binary | std::ios::trunc);
+
+    file.write(magicCheckpoint, 4);
+    put(version);
+
+    return bool(file);
+}
+
+void CheckpointWriter::putBytes(const void* data, std::size_t bytes)
+{
+    file.write(static_cast<const char*>(data), bytes);
+}
+
+void CheckpointWriter::putString(const std::string& text)
+{
+    put<std::uint64_t>(text.size());
+    putBytes(text.data(), text.size());
+}
+
+bool CheckpointWriter::commit(void)
+{
+    file.close();
+
+    std::string directory = path.find('/') == std::string::npos ? "." : path.substr(0, path.rfind('/') + 1);
+
+    /* Le contenu doit être sur le disque avant que le nouveau nom ne le désigne. */
+    if(!file || !syncPath(path + ".tmp", O_RDONLY))
+    {
+        return false;
+    }
+
+    /* Le renommage remplace l'ancien instantané d'un seul coup ; il n'est durable qu'une fois le dossier écrit. */
+    return std::rename((path + ".tmp").c_str(), path.c_str()) == 0 && syncPath(directory, O_RDONLY | O_DIRECTORY);
+}
+
+bool CheckpointReader::open(const std::string& path)
+{
+    char magic[4];
+    std::uint32_t fileVersion = 0;
+
+    file.open(path, std::ios::binary);
+
+    if(!file.read(magic, 4) || std::memcmp(magic, magicCheckpoint, 4) != 0)
+    {
+        return false;
+    }
+
+    get(fileVersion);
+
+    return good() && fileVersion == version;
+}
+
+void CheckpointReader::getBytes(void* data, std::size_t bytes)
+{
+    file.read(static_cast<char*>(data), bytes);
+}
+
+void CheckpointReader::getString(std::string& text)
+{
+    std::uint64_t size = 0;
+
+    get(size);
+    if(!file)
+    {
+        return;
+    }
+
+    text.resize(size);
+    getBytes(&text[0], size);
+}
+
+bool CheckpointReader::good(void) const
+{
+    return bool(file);
+}
+
+void installStopHandlers(void)
+{
+    std::signal(SIGTERM, onStopSignal);
+    std::signal(SIGINT, onStopSignal);
+}
+
+bool stopRequested(void)
+{
+    return stopFlag != 0;
+}
+
+bool truncateFile(const std::string& path, std::uint64_t size)
+{
+    return truncate(path.c_str(), size) == 0;
+}
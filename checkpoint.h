@@ -0,0 +1,201 @@
+#ifndef CHECKPOINT_H_INCLUDED
+#define CHECKPOINT_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+
+/**
+ * @file
+ *
+ * Instantanés (checkpoint_<id>.bin) qui permettent de reprendre une simulation interrompue.
+ *
+ * Le fichier commence par "PLCK" et un numéro de version (uint32), puis le monde
+ * y range son état, valeur par valeur, en petit-boutiste.
+ * Les vecteurs sont précédés de leur nombre d'éléments (uint64).
+ * Le fichier est d'abord écrit sous un nom temporaire, forcé sur le disque (fsync), puis renommé,
+ * et le dossier est à son tour forcé sur le disque : un instantané est donc toujours complet,
+ * même si la machine s'arrête pendant l'écriture.
+ */
+
+/**
+ * @brief
+ * Écrit un instantané.
+ */
+
+class CheckpointWriter
+{
+public:
+
+    /**
+     * @brief
+     * Méthode qui crée le fichier temporaire et écrit l'entête.
+     *
+     * @param path  Le chemin de l'instantané
+     *
+     * @return      Vrai si le fichier a pu être créé
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief
+     * Méthode qui écrit une valeur.
+     *
+     * @param value     La valeur
+     */
+    template <typename T>
+    void put(const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+     * @brief
+     * Méthode qui écrit un vecteur, précédé de sa taille.
+     *
+     * @param values    Le vecteur
+     */
+    template <typename T>
+    void putVector(const std::vector<T>& values)
+    {
+        put<std::uint64_t>(values.size());
+        putBytes(values.data(), values.size()*sizeof(T));
+    }
+
+    /**
+     * @brief
+     * Méthode qui écrit un bloc de mémoire tel quel.
+     *
+     * @param data      Le début du bloc
+     * @param bytes     La taille du bloc
+     */
+    void putBytes(const void* data, std::size_t bytes);
+
+    /**
+     * @brief
+     * Méthode qui écrit un texte, précédé de sa taille.
+     *
+     * @param text      Le texte
+     */
+    void putString(const std::string& text);
+
+    /**
+     * @brief
+     * Méthode qui ferme le fichier temporaire, le force sur le disque et le renomme en instantané.
+     *
+     * @return      Vrai si l'instantané a été entièrement écrit
+     */
+    bool commit(void);
+
+private:
+
+    std::ofstream file; /**< @brief Le fichier temporaire */
+    std::string path; /**< @brief Le chemin de l'instantané */
+};
+
+/**
+ * @brief
+ * Lit un instantané.
+ */
+
+class CheckpointReader
+{
+public:
+
+    /**
+     * @brief
+     * Méthode qui ouvre l'instantané et vérifie l'entête.
+     *
+     * @param path  Le chemin de l'instantané
+     *
+     * @return      Vrai si le fichier existe et est un instantané valide
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief
+     * Méthode qui lit une valeur.
+     *
+     * @param value     La valeur lue
+     */
+    template <typename T>
+    void get(T& value)
+    {
+        file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+
+    /**
+     * @brief
+     * Méthode qui lit un vecteur écrit par putVector.
+     *
+     * @param values    Le vecteur lu
+     */
+    template <typename T>
+    void getVector(std::vector<T>& values)
+    {
+        std::uint64_t size = 0;
+
+        get(size);
+        if(!file)
+        {
+            return;
+        }
+
+        values.resize(size);
+        getBytes(values.data(), size*sizeof(T));
+    }
+
+    /**
+     * @brief
+     * Méthode qui lit un bloc de mémoire écrit par putBytes.
+     *
+     * @param data      Le début du bloc
+     * @param bytes     La taille du bloc
+     */
+    void getBytes(void* data, std::size_t bytes);
+
+    /**
+     * @brief
+     * Méthode qui lit un texte écrit par putString.
+     *
+     * @param text      Le texte lu
+     */
+    void getString(std::string& text);
+
+    /** @brief Vrai si toutes les lectures ont réussi */
+    bool good(void) const;
+
+private:
+
+    std::ifstream file; /**< @brief Le fichier de l'instantané */
+};
+
+/**
+ * @brief
+ * Fonction qui installe les gestionnaires de SIGTERM et SIGINT.
+ *
+ * Le signal ne fait que lever un drapeau : les mondes le consultent
+ * au début de chaque génération, écrivent leur instantané et s'arrêtent.
+ * Un second signal arrête le programme immédiatement.
+ */
+void installStopHandlers(void);
+
+/** @brief Vrai si SIGTERM ou SIGINT a été reçu */
+bool stopRequested(void);
+
+/**
+ * @brief
+ * Fonction qui tronque un fichier à la taille donnée.
+ *
+ * Utile pour reprendre un rapport exactement là où en était l'instantané.
+ *
+ * @param path  Le chemin du fichier
+ * @param size  La nouvelle taille, en octets
+ *
+ * @return      Vrai si le fichier a été tronqué
+ */
+bool truncateFile(const std::string& path, std::uint64_t size);
+
+#endif // CHECKPOINT_H_INCLUDED
@@ -0,0 +1,101 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "convergence.h"
+#include "checkpoint.h"
+
+ConvergenceTracker::ConvergenceTracker(void)
+{
+    window = 0;
+    count = 0;
+    lastConflict = -1;
+    hasConverged = false;
+}
+
+void ConvergenceTracker::reset(int window)
+{
+    this->window = window;
+
+    means.assign(window, 0);
+    count = 0;
+    lastConflict = -1;
+    hasConverged = false;
+}
+
+bool ConvergenceTracker::add(double mean, double relativeConvergence, double absoluteConvergence)
+{
+    long long k = 0;
+
+    if(hasConverged || window <= 0)
+    {
+        return hasConverged;
+    }
+
+    /* On compare la nouvelle moyenne aux précédentes, de la plus récente à la plus ancienne :
+    la première dissemblance trouvée est la plus récente. */
+    for(k=count - 1; k>=0 && k>count - window && k>lastConflict; k--)
+    {
+        if(!similar(means[k%window], mean, relativeConvergence, absoluteConvergence))
+        {
+            lastConflict = k;
+        }
+    }
+
+    means[count%window] = mean;
+    count++;
+
+    /* La fenêtre est pleine et ne contient plus aucune paire dissemblable. */
+    if(count >= window && lastConflict < count - window)
+    {
+        hasConverged = true;
+    }
+
+    return hasConverged;
+}
+
+bool ConvergenceTracker::converged(void) const
+{
+    return hasConverged;
+}
+
+bool ConvergenceTracker::similar(double first_mean, double second_mean, double relativeConvergence, double absoluteConvergence)
+{
+    /* On a deux critères avec un OU logique
+    En variation relative: efficace quand la valeur est haute
+    En variation absolue: efficace quand la valeur est basse */
+    if(std::abs(first_mean - second_mean)/second_mean < relativeConvergence ||
+       (std::abs(first_mean - second_mean) < absoluteConvergence))
+    {
+        return true;
+    }
+
+    return false;
+}
+
+void ConvergenceTracker::save(CheckpointWriter& out) const
+{
+    out.put<std::int32_t>(window);
+    out.put<std::int64_t>(count);
+    out.put<std::int64_t>(lastConflict);
+    out.put<std::uint8_t>(hasConverged);
+    out.putVector(means);
+}
+
+void ConvergenceTracker::load(CheckpointReader& in)
+{
+    std::int32_t fileWindow = 0;
+    std::int64_t fileCount = 0, fileConflict = 0;
+    std::uint8_t flag = 0;
+
+    in.get(fileWindow);
+    in.get(fileCount);
+    in.get(fileConflict);
+    in.get(flag);
+    in.getVector(means);
+
+    window = fileWindow;
+    count = fileCount;
+    lastConflict = fileConflict;
+    hasConverged = flag;
+}
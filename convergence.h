@@ -0,0 +1,92 @@
+#ifndef CONVERGENCE_H_INCLUDED
+#define CONVERGENCE_H_INCLUDED
+
+#include <vector>
+
+#include "checkpoint.h"
+
+/**
+ * @file
+ */
+
+/**
+ * @brief
+ * Suit la convergence de la moyenne d'un trait au fil des vérifications.
+ *
+ * Le trait a convergé dès que les window dernières moyennes sont toutes
+ * semblables deux à deux. Les moyennes sont gardées dans un tampon circulaire ;
+ * chaque nouvelle moyenne n'est comparée qu'aux window - 1 précédentes,
+ * et on retient la dernière vérification qui lui est dissemblable.
+ * Il suffit alors de savoir si une dissemblance tombe encore dans la fenêtre,
+ * sans recompter toutes les paires.
+ */
+
+class ConvergenceTracker
+{
+public:
+
+    ConvergenceTracker(void);
+
+    /**
+     * @brief
+     * Méthode qui vide le suivi et fixe la taille de la fenêtre.
+     *
+     * @param window    Le nombre de moyennes consécutives qui doivent être semblables
+     */
+    void reset(int window);
+
+    /**
+     * @brief
+     * Méthode qui ajoute la moyenne d'une nouvelle vérification.
+     * Une fois le trait convergé, les moyennes suivantes sont ignorées.
+     *
+     * @param mean                  La moyenne du trait
+     * @param relativeConvergence   Le critère de variation relative
+     * @param absoluteConvergence   Le critère de variation absolue
+     *
+     * @return                      Vrai si le trait a convergé
+     */
+    bool add(double mean, double relativeConvergence, double absoluteConvergence);
+
+    /** @brief Vrai si le trait a convergé */
+    bool converged(void) const;
+
+    /**
+     * @brief
+     * Méthode qui compare deux moyennes et juge si elles sont suffisamment similaires selon deux critères.
+     *
+     * @param first_mean            La moyenne la plus ancienne
+     * @param second_mean           La moyenne la plus récente
+     * @param relativeConvergence   Le critère de variation relative pour juger si les moyennes sont similaires
+     * @param absoluteConvergence   Le critère de variation absoule pour juger si les moyennes sont similaires
+     *
+     * @return                      Vrai si les moyennes sont suffisamment similaires, faux sinon
+     */
+    static bool similar(double first_mean, double second_mean, double relativeConvergence, double absoluteConvergence);
+
+    /**
+     * @brief
+     * Méthode qui écrit l'état du suivi dans un instantané.
+     *
+     * @param out   L'instantané
+     */
+    void save(CheckpointWriter& out) const;
+
+    /**
+     * @brief
+     * Méthode qui relit l'état du suivi depuis un instantané.
+     *
+     * @param in    L'instantané
+     */
+    void load(CheckpointReader& in);
+
+private:
+
+    std::vector<double> means; /**< @brief Les window dernières moyennes (tampon circulaire) */
+    int window; /**< @brief La taille de la fenêtre */
+    long long count; /**< @brief Le nombre de moyennes ajoutées */
+    long long lastConflict; /**< @brief La plus récente vérification dont la moyenne est dissemblable d'une suivante (-1 : aucune) */
+    bool hasConverged; /**< @brief Si le trait a convergé */
+};
+
+#endif // CONVERGENCE_H_INCLUDED
@@ -0,0 +1,101 @@
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "dispersal.h"
+
+DispersalKernel::DispersalKernel(dispersalKernel type, double scale, int range, int neighbours, bool columns, bool rows)
+{
+    int dx = 0, dy = 0;
+    double sum = 0;
+
+    int dimensions = int(columns) + int(rows);
+
+    /* Les voisins immédiats sont à un patch. */
+    int reach = (type == nearestKernel) ? 1 : range;
+
+    /* Sur une chaîne, seules les colonnes varient (et seules les lignes sur une grille d'une colonne). */
+    int reachX = columns ? reach : 0;
+    int reachY = rows ? reach : 0;
+
+    for(dx=-reachX; dx<=reachX; dx++)
+    {
+        for(dy=-reachY; dy<=reachY; dy++)
+        {
+            double w = 0;
+
+            if(dx == 0 && dy == 0)
+            {
+                continue;
+            }
+
+            w = weight(type, scale, reach, neighbours, dimensions, dx, dy);
+
+            if(w > 0)
+            {
+                stencil.push_back({dx, dy, w});
+                sum += w;
+            }
+        }
+    }
+
+    /* Toutes les graines dispersantes arrivent à portée. */
+    for(DispersalOffset& offset : stencil)
+    {
+        offset.share /= sum;
+    }
+}
+
+const std::vector<DispersalOffset>& DispersalKernel::offsets(void) const
+{
+    return stencil;
+}
+
+const char* DispersalKernel::name(dispersalKernel type)
+{
+    switch(type)
+    {
+        case exponentialKernel:
+            return "exponential";
+        case cauchyKernel:
+            return "cauchy";
+        case geometricKernel:
+            return "geometric";
+        default:
+            return "nearest";
+    }
+}
+
+double DispersalKernel::weight(dispersalKernel type, double scale, int range, int neighbours, int dimensions, int dx, int dy)
+{
+    double distance = std::sqrt(double(dx*dx + dy*dy));
+
+    /* Le nombre de pas (avec les diagonales) : les patchs à k pas forment un anneau. */
+    int ring = std::max(std::abs(dx), std::abs(dy));
+
+    switch(type)
+    {
+        case nearestKernel:
+            return (ring == 1 && (neighbours == 8 || dx == 0 || dy == 0)) ? 1 : 0;
+
+        case exponentialKernel:
+            return (distance <= range) ? std::exp(-distance/scale) : 0;
+
+        case cauchyKernel:
+            /* La densité de Cauchy en d dimensions décroît en (1 + (r/scale)²)^(-(d+1)/2). */
+            return (distance <= range) ? std::pow(1 + (distance/scale)*(distance/scale), -0.5*(dimensions + 1)) : 0;
+
+        case geometricKernel:
+        {
+            /* Le nombre de pas suit une loi géométrique de moyenne scale,
+            puis chaque patch de l'anneau reçoit la même part. */
+            double p = 1/scale;
+            int ringSize = (dimensions == 1) ? 2 : 8*ring;
+
+            return (ring <= range) ? p*std::pow(1 - p, ring - 1)/ringSize : 0;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef DISPERSAL_H_INCLUDED
+#define DISPERSAL_H_INCLUDED
+
+#include <vector>
+
+/**
+ * @file
+ */
+
+/** @brief Énumération qui permet de choisir comment les graines dispersantes se répartissent avec la distance. */
+typedef enum _kernel_
+{
+    nearestKernel = 0,      /**< Les voisins immédiats seulement (4 ou 8 sur une grille), à parts égales */
+    exponentialKernel = 1,  /**< Poids exp(-distance/scale) */
+    cauchyKernel = 2,       /**< Queue épaisse : loi de Cauchy de largeur scale (en une ou deux dimensions) */
+    geometricKernel = 3,    /**< Loi géométrique de moyenne scale sur le nombre de pas (anneaux de patchs) */
+} dispersalKernel;
+
+/**
+ * @brief
+ * Un décalage (en patchs) depuis le patch d'origine des graines,
+ * avec la part des graines dispersantes qui y arrive.
+ */
+typedef struct _DispersalOffset_
+{
+    int dx; /**< @brief Le décalage en colonnes */
+    int dy; /**< @brief Le décalage en lignes */
+    double share; /**< @brief La part des graines dispersantes d'un individu qui arrive dans ce patch */
+} DispersalOffset;
+
+/**
+ * @brief
+ * Le noyau de dispersion : la part des graines dispersantes qui arrive
+ * à chaque distance de son patch d'origine.
+ *
+ * Les poids sont calculés une seule fois, sur une grille infinie (ou une chaîne infinie),
+ * puis normalisés sur les patchs à portée : toutes les graines dispersantes
+ * arrivent à portée, et celles qui arriveraient hors du monde sont perdues.
+ */
+
+class DispersalKernel
+{
+public:
+
+    /**
+     * @brief
+     * Constructeur du noyau.
+     *
+     * @param type          La forme du noyau
+     * @param scale         L'échelle du noyau, en patchs (sans effet pour nearestKernel)
+     * @param range         La distance maximale de dispersion, en patchs (1 pour nearestKernel)
+     * @param neighbours    Le nombre de voisins immédiats sur une grille (4 ou 8, pour nearestKernel)
+     * @param columns       Vrai si le monde a plusieurs colonnes
+     * @param rows          Vrai si le monde a plusieurs lignes
+     */
+    DispersalKernel(dispersalKernel type, double scale, int range, int neighbours, bool columns, bool rows);
+
+    /** @brief Les décalages à portée (sauf le patch d'origine), triés par colonne puis par ligne */
+    const std::vector<DispersalOffset>& offsets(void) const;
+
+    /**
+     * @brief
+     * Le nom d'un noyau, tel qu'il est donné par kernel=...
+     *
+     * @param type      La forme du noyau
+     */
+    static const char* name(dispersalKernel type);
+
+private:
+
+    std::vector<DispersalOffset> stencil; /**< @brief Les décalages à portée et leur part */
+
+    /**
+     * @brief
+     * Le poids (non normalisé) d'un décalage, 0 s'il est hors de portée.
+     *
+     * @param type          La forme du noyau
+     * @param scale         L'échelle du noyau
+     * @param range         La distance maximale de dispersion
+     * @param neighbours    Le nombre de voisins immédiats sur une grille
+     * @param dimensions    Le nombre de dimensions du monde (1 pour une chaîne, 2 pour une grille)
+     * @param dx            Le décalage en colonnes
+     * @param dy            Le décalage en lignes
+     */
+    static double weight(dispersalKernel type, double scale, int range, int neighbours, int dimensions, int dx, int dy);
+};
+
+#endif // DISPERSAL_H_INCLUDED
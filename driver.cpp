@@ -0,0 +1,480 @@
+#include <array>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <unistd.h>
+
+#include "driver.h"
+#include "options.h"
+#include "world.h"
+#include "thread_pool.h"
+#include "checkpoint.h"
+#include "meanfield.h"
+
+bool readConfigLine(const std::string& line, Parameters& params)
+{
+    int i = 0;
+
+    std::istringstream iss(line);
+
+    for(i=1; i<int(params.size()); i++)
+    {
+        if(!(iss >> params[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool readConfigFiles(const std::vector<std::string>& configFiles, std::vector<Parameters>& points)
+{
+    for(const std::string& configFile : configFiles)
+    {
+        std::ifstream config(configFile);
+        std::string line;
+
+        if(!config)
+        {
+            std::cerr << "Impossible d'ouvrir " << configFile << std::endl;
+            return false;
+        }
+
+        while(std::getline(config, line))
+        {
+            Parameters params;
+            params[0] = 0;
+
+            if(line.find_first_not_of(" \t\r") == std::string::npos)
+            {
+                continue; // Ligne vide
+            }
+
+            if(!readConfigLine(line, params))
+            {
+                std::cerr << "Ligne invalide dans " << configFile << " : " << line << std::endl;
+                return false;
+            }
+
+            points.push_back(params);
+        }
+    }
+
+    return true;
+}
+
+std::vector<int> predictK(const Parameters& params, const Options& options)
+{
+    return World::buildK(params[1], options.width, params[12], params[13], params[14], params[15]);
+}
+
+
+bool runWorld(const Parameters& params, const Options& options, ReplicateResult* result)
+{
+    int i = 0;
+
+    World world(params[0], params[1], params[2], params[3],
+    params[4], params[5], params[6], params[7], params[8], params[9],
+    params[10], params[11], params[12], params[13], params[14],
+    params[15], params[16], params[17], params[18], params[19],
+    params[20], params[21], params[22], params[23], params[24], params[25],
+    params[26], params[27], params[28], params[29], params[30], options);
+
+    if(!world.run(params[0]))
+    {
+        return false;
+    }
+
+    if(result != nullptr)
+    {
+        std::vector<double> meanS, meanD;
+        world.patchMeans(meanS, meanD);
+
+        result->s = 0;
+        result->d = 0;
+
+        for(i=0; i<int(meanS.size()); i++)
+        {
+            result->s += meanS[i];
+            result->d += meanD[i];
+        }
+
+        result->s /= meanS.size();
+        result->d /= meanD.size();
+    }
+
+    return true;
+}
+
+double confidenceHalfWidth(const std::vector<double>& values)
+{
+    /* Les quantiles à 97,5 % de la loi de Student, de 1 à 30 degrés de liberté. */
+    static const double student[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                       2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                       2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+    int n = values.size();
+    double mean = 0, variance = 0;
+
+    for(double value : values)
+    {
+        mean += value;
+    }
+    mean /= n;
+
+    for(double value : values)
+    {
+        variance += (value - mean)*(value - mean);
+    }
+    variance /= n - 1;
+
+    double quantile = (n - 1 <= 30) ? student[n - 2] : 1.96;
+
+    return quantile*std::sqrt(variance/n);
+}
+
+/**
+ * @brief
+ * Un point du balayage (une ligne d'un fichier de configuration) et l'état de ses réplicats.
+ */
+typedef struct _SweepPoint_
+{
+    Parameters params; /**< @brief Les paramètres du point (params[0] est fixé à chaque réplicat) */
+    int firstWorldId; /**< @brief L'identifiant du premier réplicat */
+    double memory; /**< @brief La mémoire occupée par un réplicat */
+
+    int launched; /**< @brief Le nombre de réplicats lancés (toujours les premiers) */
+    int counted; /**< @brief Le nombre de premiers réplicats terminés et pris en compte */
+    bool precise; /**< @brief Si les réplicats comptés ont atteint la précision visée */
+
+    std::vector<char> finished; /**< @brief Pour chaque réplicat, s'il est terminé (ou a échoué) */
+    std::vector<char> valid; /**< @brief Pour chaque réplicat, s'il a donné ses moyennes */
+    std::vector<ReplicateResult> results; /**< @brief Les moyennes finales de chaque réplicat */
+} SweepPoint;
+
+int runSweep(const std::vector<std::string>& configFiles, int replicates, int firstWorldId, const Options& options)
+{
+    int i = 0;
+    int worldId = firstWorldId;
+
+    std::vector<SweepPoint> points;
+
+    bool adaptive = (options.targetHalfWidth > 0);
+
+    /* Lecture de tous les points à simuler. */
+    std::vector<Parameters> lines;
+    if(!readConfigFiles(configFiles, lines))
+    {
+        return 1;
+    }
+
+    for(const Parameters& params : lines)
+    {
+        SweepPoint point;
+
+        point.params = params;
+        point.firstWorldId = worldId;
+        point.memory = World::predictMemory(predictK(params, options), params[4], options);
+        point.launched = 0;
+        point.counted = 0;
+        point.precise = false;
+        point.finished.assign(replicates, 0);
+        point.valid.assign(replicates, 0);
+        point.results.resize(replicates);
+
+        points.push_back(point);
+        worldId += replicates;
+    }
+
+    int nWorkers = options.workers;
+    if(nWorkers <= 0)
+    {
+        nWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    double budget = options.memory*1e9;
+    if(budget <= 0)
+    {
+        budget = 0.9*double(sysconf(_SC_PHYS_PAGES))*double(sysconf(_SC_PAGE_SIZE));
+    }
+
+    /* Chaque monde a sa propre graine, dérivée d'une graine commune. */
+    std::uint64_t baseSeed = std::chrono::system_clock::now().time_since_epoch().count();
+    if(options.seedIsSet)
+    {
+        baseSeed = options.seed;
+    }
+
+    if(adaptive)
+    {
+        std::cout << points.size() << " points, de " << options.minReplicates << " à " << replicates
+                  << " réplicats (demi-largeur visée " << options.targetHalfWidth << ")";
+    }
+    else
+    {
+        std::cout << points.size()*replicates << " mondes";
+    }
+    std::cout << " sur " << nWorkers << " threads, " << budget/1e9 << " Go disponibles, graine " << baseSeed << std::endl;
+
+    std::mutex mutex;
+    std::condition_variable released;
+    double used = 0; // La mémoire réservée par les mondes en cours.
+    int running = 0;
+    int failures = 0;
+    int stopped = 0; // Les mondes arrêtés par un signal, et ceux qui n'ont pas été lancés.
+
+    /* Le prochain point qui peut lancer un réplicat, -1 s'il n'y en a pas pour l'instant
+    (à appeler sous le verrou). Les points sont servis dans l'ordre, comme avant. */
+    auto nextPoint = [&](void)
+    {
+        int p = 0;
+
+        for(p=0; p<int(points.size()); p++)
+        {
+            const SweepPoint& point = points[p];
+
+            if(point.precise || point.launched >= replicates)
+            {
+                continue;
+            }
+
+            /* Au plus min réplicats lancés au-delà de ceux déjà comptés. */
+            if(!adaptive || point.launched - point.counted < options.minReplicates)
+            {
+                return p;
+            }
+        }
+
+        return -1;
+    };
+
+    /* Avance les réplicats comptés d'un point, dans l'ordre, et teste la précision (sous le verrou). */
+    auto countReplicates = [&](SweepPoint& point)
+    {
+        int r = 0;
+
+        while(!point.precise && point.counted < point.launched && point.finished[point.counted])
+        {
+            point.counted++;
+
+            std::vector<double> s, d;
+            for(r=0; r<point.counted; r++)
+            {
+                if(point.valid[r])
+                {
+                    s.push_back(point.results[r].s);
+                    d.push_back(point.results[r].d);
+                }
+            }
+
+            if(adaptive && point.counted >= options.minReplicates && s.size() >= 2
+            && confidenceHalfWidth(s) <= options.targetHalfWidth && confidenceHalfWidth(d) <= options.targetHalfWidth)
+            {
+                point.precise = true;
+            }
+        }
+    };
+
+    /* Le thread appelant ne fait que l'admission des mondes. */
+    ThreadPool pool(nWorkers + 1);
+
+    if(options.checkpointFrequency > 0)
+    {
+        installStopHandlers();
+    }
+
+    while(true)
+    {
+        int p = -1, replicate = 0;
+        double memory = 0;
+
+        /* On attend qu'un point puisse lancer un réplicat, qu'un thread soit libre et que la mémoire suffise.
+        Un monde plus gros que toute la mémoire est lancé seul. Sans réplicat à lancer ni monde en cours,
+        le balayage est fini. */
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [&]
+            {
+                p = nextPoint();
+                if(p < 0)
+                {
+                    return running == 0;
+                }
+
+                memory = points[p].memory;
+                return running == 0 || (running < nWorkers && used + memory <= budget);
+            });
+
+            /* Après un signal d'arrêt, on ne lance plus de nouveau monde. */
+            if(p < 0 || stopRequested())
+            {
+                stopped += (p >= 0);
+                break;
+            }
+
+            replicate = points[p].launched;
+            points[p].launched++;
+            used += memory;
+            running++;
+        }
+
+        Parameters params = points[p].params;
+        params[0] = points[p].firstWorldId + replicate;
+
+        Options worldOptions = options;
+        worldOptions.progress = false;
+        worldOptions.seedIsSet = true;
+        worldOptions.seed = baseSeed + std::uint64_t(params[0]);
+
+        pool.submit([&, p, replicate, params, memory, worldOptions]
+        {
+            bool failed = false, completed = false;
+            ReplicateResult result = {0, 0};
+
+            try
+            {
+                completed = runWorld(params, worldOptions, &result);
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << "Monde " << params[0] << " interrompu : " << e.what() << std::endl;
+                failed = true;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                used -= memory;
+                running--;
+                failures += failed;
+                stopped += !completed && !failed;
+
+                /* Un monde arrêté par un signal n'est pas terminé : il sera repris. */
+                if(completed || failed)
+                {
+                    points[p].finished[replicate] = 1;
+                    points[p].valid[replicate] = completed;
+                    points[p].results[replicate] = result;
+                    countReplicates(points[p]);
+                }
+            }
+
+            if(completed)
+            {
+                std::cout << "Monde " << params[0] << " terminé" << std::endl;
+            }
+            released.notify_all();
+        });
+    }
+
+    pool.wait();
+
+    /* Les moyennes d'un balayage arrêté seraient partielles : le résumé est laissé à la reprise. */
+    if(stopped > 0)
+    {
+        std::cerr << "Balayage arrêté : relancer la même commande avec resume=1 pour le terminer" << std::endl;
+        return stoppedExitCode;
+    }
+
+    /* Le résumé de chaque point : les réplicats comptés, les moyennes de s et de d
+    et la demi-largeur de leur intervalle de confiance à 95 %. */
+    std::ofstream summary("sweep_" + std::to_string(firstWorldId) + ".txt");
+    summary << "Point\tPremierMonde\tRéplicats\tPrécis\ts\tICs\td\tICd" << std::endl;
+
+    for(i=0; i<int(points.size()); i++)
+    {
+        const SweepPoint& point = points[i];
+        std::vector<double> s, d;
+        int r = 0;
+
+        for(r=0; r<point.counted; r++)
+        {
+            if(point.valid[r])
+            {
+                s.push_back(point.results[r].s);
+                d.push_back(point.results[r].d);
+            }
+        }
+
+        double meanS = 0, meanD = 0;
+        for(r=0; r<int(s.size()); r++)
+        {
+            meanS += s[r];
+            meanD += d[r];
+        }
+        if(!s.empty())
+        {
+            meanS /= s.size();
+            meanD /= d.size();
+        }
+
+        double halfS = (s.size() >= 2) ? confidenceHalfWidth(s) : 0;
+        double halfD = (d.size() >= 2) ? confidenceHalfWidth(d) : 0;
+
+        summary << i << "\t" << point.firstWorldId << "\t" << s.size() << "\t" << int(point.precise)
+                << "\t" << meanS << "\t" << halfS << "\t" << meanD << "\t" << halfD << std::endl;
+
+        if(adaptive)
+        {
+            std::cout << "Point " << i << " : " << s.size() << " réplicats, s = " << meanS << " ± " << halfS
+                      << ", d = " << meanD << " ± " << halfD << (point.precise ? "" : " (précision non atteinte)") << std::endl;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
+
+int runMeanField(const std::vector<std::string>& configFiles, int firstPoint, const Options& options)
+{
+    int i = 0;
+
+    std::vector<Parameters> points;
+    if(!readConfigFiles(configFiles, points))
+    {
+        return 1;
+    }
+
+    std::ofstream summary("meanfield_" + std::to_string(firstPoint) + ".txt");
+    std::ofstream patches("meanfield_patches_" + std::to_string(firstPoint) + ".txt");
+
+    /* Les colonnes du résumé d'un balayage (un seul « réplicat », sans intervalle de confiance),
+    puis celles propres au champ moyen. */
+    summary << "Point\tPremierMonde\tRéplicats\tPrécis\ts\tICs\td\tICd\tItérations\tConvergé\tf" << std::endl;
+    patches << "Point\tPatch\tx\ty\tK\tP\ts\td\tf" << std::endl;
+
+    for(i=0; i<int(points.size()); i++)
+    {
+        int point = i;
+
+        try
+        {
+            MeanField model(points[i], options);
+            bool converged = model.solve();
+
+            summary << point << "\t" << firstPoint + i << "\t1\t0\t" << model.meanS() << "\t0\t" << model.meanD()
+                    << "\t0\t" << model.iterations() << "\t" << int(converged) << "\t" << model.meanF() << std::endl;
+            model.writePatches(patches, point);
+
+            std::cout << "Point " << point << " : s = " << model.meanS() << ", d = " << model.meanD()
+                      << ", f = " << model.meanF() << " en " << model.iterations() << " itérations"
+                      << (converged ? "" : " (équilibre non atteint)") << std::endl;
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << "Point " << point << " : " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#ifndef DRIVER_H_INCLUDED
+#define DRIVER_H_INCLUDED
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "options.h"
+
+/**
+ * @file
+ */
+
+/** @brief Les 31 paramètres d'un monde, dans l'ordre de la ligne de commande (l'identifiant en premier). */
+typedef std::array<double, 31> Parameters;
+
+/** @brief Le code de sortie quand un monde a été arrêté par un signal : il reste à le reprendre avec resume=1. */
+const int stoppedExitCode = 2;
+
+/**
+ * @brief
+ * Fonction qui lit les paramètres d'un monde, sauf son identifiant,
+ * depuis une ligne d'un fichier config_N.txt.
+ *
+ * @param line      La ligne du fichier
+ * @param params    Les paramètres à remplir (params[0] n'est pas modifié)
+ *
+ * @return          Vrai si les 30 paramètres ont été lus
+ */
+bool readConfigLine(const std::string& line, Parameters& params);
+
+/**
+ * @brief
+ * Fonction qui lit toutes les lignes des fichiers de configuration (les lignes vides sont ignorées).
+ *
+ * @param configFiles   Les fichiers de configuration
+ * @param points        Reçoit les paramètres de chaque ligne, dans l'ordre (params[0] vaut 0)
+ *
+ * @return              Vrai si tous les fichiers ont été lus, faux sinon (le problème est affiché)
+ */
+bool readConfigFiles(const std::vector<std::string>& configFiles, std::vector<Parameters>& points);
+
+/**
+ * @brief
+ * Fonction qui calcule les K d'un monde à partir de ses paramètres.
+ *
+ * @param params    Les paramètres du monde
+ * @param options   Les réglages facultatifs (forme de la grille)
+ *
+ * @return          La valeur de K pour chaque patch
+ */
+std::vector<int> predictK(const Parameters& params, const Options& options);
+
+/** @brief Les moyennes finales d'un monde : la moyenne, sur les patchs, des moyennes de chaque patch. */
+typedef struct _ReplicateResult_
+{
+    double s; /**< @brief La moyenne finale de s */
+    double d; /**< @brief La moyenne finale de d */
+} ReplicateResult;
+
+/**
+ * @brief
+ * Fonction qui construit un monde et lance sa simulation.
+ *
+ * @param params    Les paramètres du monde
+ * @param options   Les réglages facultatifs
+ * @param result    Reçoit les moyennes finales du monde s'il est allé à son terme (peut être nul)
+ *
+ * @return          Vrai si la simulation est allée à son terme, faux si elle a été arrêtée par un signal
+ */
+bool runWorld(const Parameters& params, const Options& options, ReplicateResult* result = nullptr);
+
+/**
+ * @brief
+ * Fonction qui calcule la demi-largeur de l'intervalle de confiance à 95 % d'une moyenne
+ * (quantile de Student, puis de la loi normale au-delà de 30 degrés de liberté).
+ *
+ * @param values    Les valeurs (au moins deux)
+ *
+ * @return          La demi-largeur de l'intervalle
+ */
+double confidenceHalfWidth(const std::vector<double>& values);
+
+/**
+ * @brief
+ * Fonction qui simule tous les réplicats de toutes les lignes des fichiers de configuration
+ * dans le même processus.
+ *
+ * Les mondes sont lancés sur un groupe de threads de la taille de la machine,
+ * à condition que la mémoire qu'ils vont occuper reste disponible.
+ * Les identifiants des mondes se suivent à partir de firstWorldId
+ * (fichier par fichier, ligne par ligne, réplicat par réplicat) ; chaque point
+ * réserve replicates identifiants, même s'il en utilise moins.
+ * Après SIGTERM ou SIGINT (avec checkpoint=N), plus aucun monde n'est lancé
+ * et ceux en cours écrivent leur instantané ; resume=1 reprend ensuite le balayage.
+ * Le résumé d'un balayage arrêté n'est pas écrit (il le sera par la reprise).
+ *
+ * Avec ci=W, les réplicats d'un point sont lancés peu à peu (au plus min=N en cours) :
+ * le point s'arrête au premier n >= N tel que les n premiers réplicats donnent un intervalle
+ * de confiance à 95 % de demi-largeur au plus W pour la moyenne de s et pour celle de d.
+ * La règle ne regarde que les réplicats dans l'ordre de leurs identifiants : le nombre
+ * de réplicats ne dépend donc pas de l'ordre dans lequel les mondes se terminent
+ * (les réplicats déjà lancés au-delà de n vont à leur terme mais ne sont pas comptés).
+ * Le résumé de chaque point est écrit dans sweep_<firstWorldId>.txt.
+ *
+ * @param configFiles   Les fichiers de configuration (une ligne de paramètres par point)
+ * @param replicates    Le nombre de réplicats par ligne (le plafond avec ci=W)
+ * @param firstWorldId  L'identifiant du premier monde
+ * @param options       Les réglages facultatifs
+ *
+ * @return              0 si tout s'est bien passé, stoppedExitCode si le balayage a été arrêté par un signal, 1 sinon
+ */
+int runSweep(const std::vector<std::string>& configFiles, int replicates, int firstWorldId, const Options& options);
+
+/**
+ * @brief
+ * Fonction qui calcule l'équilibre en champ moyen (voir MeanField) de chaque ligne des fichiers de configuration.
+ *
+ * Les moyennes de chaque point sont écrites dans meanfield_<firstPoint>.txt, avec les colonnes
+ * du résumé d'un balayage (Point, numéroté à partir de 0 dans l'ordre des lignes, PremierMonde = firstPoint + Point,
+ * Réplicats = 1, Précis = 0, demi-largeurs ICs et ICd nulles), suivies de Itérations, Convergé et f.
+ * Le détail par patch est écrit dans meanfield_patches_<firstPoint>.txt, avec la même numérotation des points.
+ *
+ * @param configFiles   Les fichiers de configuration (une ligne de paramètres par point)
+ * @param firstPoint    Le numéro donné au premier point (colonne PremierMonde et nom des fichiers)
+ * @param options       Les réglages facultatifs
+ *
+ * @return              0 si tout s'est bien passé, 1 sinon
+ */
+int runMeanField(const std::vector<std::string>& configFiles, int firstPoint, const Options& options);
+
+#endif // DRIVER_H_INCLUDED
@@ -12,42 +12,6 @@ Individual::Individual(double s, double d, double f)
     this->f = f;
 }
 
-void Individual::calcDispPress(double delta, double c, bool pollenized, std::vector<double>& press)
-{
-    /* La dépression de consanguinité subie par l'individu, déterminée grace à la fonction f_to_delta. */
-    double ind_delta = f_to_delta(delta, f);
-
-    press.push_back(s*(1-ind_delta)*(1-c)*(0.5*d));
-
-    if(pollenized)
-    {
-        press.push_back((1-s)*(1-ind_delta)*(1-c)*(0.5*d));
-    }
-
-    else
-    {
-        press.push_back(0);
-    }
-}
-
-void Individual::calcResidPress(double delta, bool pollenized, std::vector<double>& press)
-{
-    /* La dépression de consanguinité subie par l'individu, déterminée grace à la fonction f_to_delta. */
-    double ind_delta = f_to_delta(delta, f);
-
-    press.push_back(s*(1-ind_delta)*(1-d));
-
-    if(pollenized)
-    {
-        press.push_back((1-s)*(1-ind_delta)*(1-d));
-    }
-
-    else
-    {
-        press.push_back(0);
-    }
-}
-
 double Individual::f_to_delta(double delta, double f)
 {
     /* La différence entre la dépression consanguine pour f = 0.5 et f = 1. */
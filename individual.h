@@ -24,30 +24,6 @@ public:
 
     double f; /**< @brief Le taux de consanguinité, utilisé si on gère l'apparentement */
 
-    /**
-     * @brief
-     * Méthode qui calcule les pressions en propagules dipersantes générées par cet individu.
-     *
-     * @param delta         La dépression de consanguinité
-     * @param c             Le coût de la dispersion
-     * @param pollenized    L'état de pollinisation du patch de l'individu
-     * @param press         Le vecteur de pression à remplir
-     */
-    void calcDispPress(double delta, double c, bool pollenized, std::vector<double>& press);
-
-    /**
-     * @brief
-     * Méthode qui calcule les pressions en propagules résidentes générées par cet individu.
-     *
-     * @param delta         La dépression de consanguinité
-     * @param c             Le coût de la dispersion
-     * @param pollenized    L'état de pollinisation du patch de l'individu
-     * @param press         Le vecteur de pression à remplir
-     */
-    void calcResidPress(double delta, bool pollenized, std::vector<double>& press);
-
-private:
-
     /**
      * @brief
      * Méthode qui calcule la dépression de consanguinité
@@ -58,7 +34,7 @@ private:
      *
      * @return      La dépression de consanguinité subie par l'individu.
      */
-    double f_to_delta(double delta, double f);
+    static double f_to_delta(double delta, double f);
 };
 
 
@@ -1,15 +1,117 @@
 #include <sstream>
+#include <iostream>
 #include <array>
+#include <string>
+#include <vector>
+#include <exception>
 
 #include "world.h"
+#include "options.h"
+#include "driver.h"
+
+/**
+ * @brief
+ * Mode --sweep : ./model --sweep <réplicats> <premier id> config_0.txt [config_1.txt ...] [cle=valeur ...]
+ *
+ * Chaque ligne des fichiers contient les 30 paramètres d'un monde, sans l'identifiant.
+ */
+int mainSweep(int argc, char *argv[])
+{
+    int i = 0;
+    int replicates = 0, firstWorldId = 0;
+
+    Options options;
+    std::vector<std::string> configFiles;
+
+    if(argc < 5 || !(std::istringstream(argv[2]) >> replicates) || !(std::istringstream(argv[3]) >> firstWorldId))
+    {
+        std::cerr << "Usage : " << argv[0] << " --sweep <réplicats> <premier id> <config...> [cle=valeur ...]" << std::endl;
+        return 1;
+    }
+
+    for(i=4; i<argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if(arg.find('=') == std::string::npos)
+        {
+            configFiles.push_back(arg);
+        }
+        else if(!options.parse(arg))
+        {
+            std::cerr << "Réglage inconnu ou invalide : " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    return runSweep(configFiles, replicates, firstWorldId, options);
+}
+
+/**
+ * @brief
+ * Mode --meanfield : ./model --meanfield <premier point> config_0.txt [config_1.txt ...] [cle=valeur ...]
+ *
+ * Calcule l'équilibre en champ moyen de chaque ligne des fichiers, sans simulation.
+ */
+int mainMeanField(int argc, char *argv[])
+{
+    int i = 0;
+    int firstPoint = 0;
+
+    Options options;
+    std::vector<std::string> configFiles;
+
+    if(argc < 4 || !(std::istringstream(argv[2]) >> firstPoint))
+    {
+        std::cerr << "Usage : " << argv[0] << " --meanfield <premier point> <config...> [cle=valeur ...]" << std::endl;
+        return 1;
+    }
+
+    for(i=3; i<argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if(arg.find('=') == std::string::npos)
+        {
+            configFiles.push_back(arg);
+        }
+        else if(!options.parse(arg))
+        {
+            std::cerr << "Réglage inconnu ou invalide : " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    return runMeanField(configFiles, firstPoint, options);
+}
 
 int main(int argc, char *argv[])
 {
     int i = 0;
-    std::array<double, 31> params;
+    Parameters params;
 
     int checkSum = 0; // égal à la longeur de params si les conversions ont bien eu lieu.
 
+    Options options;
+
+    if(argc > 1 && std::string(argv[1]) == "--sweep")
+    {
+        return mainSweep(argc, argv);
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "--meanfield")
+    {
+        return mainMeanField(argc, argv);
+    }
+
+    if(argc < 32)
+    {
+        std::cerr << "Usage : " << argv[0] << " <31 paramètres> [cle=valeur ...]" << std::endl;
+        std::cerr << "        " << argv[0] << " --sweep <réplicats> <premier id> <config...> [cle=valeur ...]" << std::endl;
+        std::cerr << "        " << argv[0] << " --meanfield <premier point> <config...> [cle=valeur ...]" << std::endl;
+        return 1;
+    }
+
     /* Conversion char* -> double */
     for(i=0; i<31; i++)
     {
@@ -22,15 +124,30 @@ int main(int argc, char *argv[])
     }
 
 
-    if(checkSum == params.size())
+    /* Les réglages facultatifs suivent les paramètres du modèle. */
+    for(i=32; i<argc; i++)
     {
-        World world(params[0], params[1], params[2], params[3],
-        params[4], params[5], params[6], params[7], params[8], params[9],
-        params[10], params[11], params[12], params[13], params[14],
-        params[15], params[16], params[17], params[18], params[19],
-        params[20], params[21], params[22], params[23], params[24], params[25],
-        params[26], params[27], params[28], params[29], params[30]);
-        world.run(params[0]);
+        if(!options.parse(argv[i]))
+        {
+            std::cerr << "Réglage inconnu ou invalide : " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    if(checkSum == int(params.size()))
+    {
+        try
+        {
+            if(!runWorld(params, options))
+            {
+                return stoppedExitCode;
+            }
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << "Monde " << params[0] << " interrompu : " << e.what() << std::endl;
+            return 1;
+        }
     }
 
     return 0;
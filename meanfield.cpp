@@ -0,0 +1,431 @@
+#include <vector>
+#include <cmath>
+#include <ostream>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "meanfield.h"
+#include "individual.h"
+#include "dispersal.h"
+
+MeanField::MeanField(const Parameters& params, const Options& options)
+{
+    int i = 0;
+
+    NPatch = params[1];
+
+    columns = (options.width > 0) ? options.width : NPatch;
+    rows = NPatch/columns;
+
+    if(NPatch%columns != 0)
+    {
+        throw std::runtime_error("le nombre de patchs n'est pas un multiple de width=" + std::to_string(options.width));
+    }
+
+    /* Les distributions linéaires répartissent leurs pas entre les colonnes : il en faut au moins deux. */
+    if(columns < 2 && (int(params[12]) != 0 || int(params[16]) != 0))
+    {
+        throw std::runtime_error("une distribution linéaire de K ou de P demande au moins deux colonnes de patchs");
+    }
+
+    if(options.kernel == geometricKernel && options.kernelScale < 1)
+    {
+        throw std::runtime_error("kernel=geometric demande scale=1 ou plus (le nombre moyen de pas)");
+    }
+
+    delta = params[2];
+    c = params[3];
+    relatednessIsManaged = params[4];
+    mitigateRelatedness = params[5];
+
+    typeMut = distrMut(int(params[8]));
+    mu = std::min(params[9], 1.0);
+    sigmaZ = params[10];
+    d_s_relativeMutation = params[11];
+
+    maxIterations = options.meanFieldIterations;
+    tolerance = options.meanFieldTolerance;
+    iterationCount = 0;
+
+    K = World::buildK(NPatch, options.width, params[12], params[13], params[14], params[15]);
+    P = World::buildP(NPatch, options.width, params[16], params[17], params[18], params[19]);
+
+    DispersalKernel kernel(options.kernel, options.kernelScale, options.kernelRange, options.neighbours, columns > 1, rows > 1);
+    World::buildSeedSources(columns, rows, kernel, seedSources, seedShares, firstSeedSource);
+
+    /* Comme dans World, les individus de départ ne sont pas consanguins. */
+    s.assign(NPatch, params[20]);
+    d.assign(NPatch, params[21]);
+    f.assign(NPatch, 0);
+    theta.assign(NPatch, 0);
+    inbreeding.assign(NPatch, 0);
+
+    /* Les vecteurs de travail d'une itération. */
+    resident.resize(NPatch);
+    dispersing.resize(NPatch);
+    meanDispersing.resize(NPatch);
+    immigrants.resize(NPatch);
+
+    sRecruit.resize(NPatch);
+    dRecruit.resize(NPatch);
+    fRecruit.resize(NPatch);
+    inbreedingRecruit.resize(NPatch);
+    thetaRecruit.resize(NPatch);
+
+    int maxSources = 0;
+    for(i=0; i<NPatch; i++)
+    {
+        maxSources = std::max(maxSources, firstSeedSource[i + 1] - firstSeedSource[i]);
+    }
+    recruitShare.resize(maxSources);
+
+    for(i=0; i<NPatch; i++)
+    {
+        if(K[i] <= 0)
+        {
+            throw std::runtime_error("le champ moyen demande K > 0 dans chaque patch");
+        }
+    }
+}
+
+bool MeanField::solve(void)
+{
+    while(iterationCount < maxIterations)
+    {
+        double change = step();
+        iterationCount++;
+
+        if(change < tolerance)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int MeanField::iterations(void) const
+{
+    return iterationCount;
+}
+
+double MeanField::meanS(void) const
+{
+    double sum = 0;
+
+    for(double value : s)
+    {
+        sum += value;
+    }
+
+    return sum/NPatch;
+}
+
+double MeanField::meanD(void) const
+{
+    double sum = 0;
+
+    for(double value : d)
+    {
+        sum += value;
+    }
+
+    return sum/NPatch;
+}
+
+double MeanField::meanF(void) const
+{
+    double sum = 0;
+
+    for(double value : f)
+    {
+        sum += value;
+    }
+
+    return sum/NPatch;
+}
+
+void MeanField::writePatches(std::ostream& out, int point) const
+{
+    int i = 0;
+
+    for(i=0; i<NPatch; i++)
+    {
+        out << point << "\t" << i << "\t" << i/rows << "\t" << i%rows << "\t" << K[i] << "\t" << P[i]
+            << "\t" << s[i] << "\t" << d[i] << "\t" << f[i] << std::endl;
+    }
+}
+
+double MeanField::step(void)
+{
+    int i = 0, j = 0, k = 0, pi = 0, pj = 0;
+    double change = 0;
+
+    /* Les pressions de chaque patch, pollinisé ou non, avec les formules de Patch (getResidPress, updateDispSeeds). */
+    for(j=0; j<NPatch; j++)
+    {
+        double survival = seedSurvival(selfedFraction(s[j], P[j]), theta[j], inbreeding[j]);
+
+        for(pj=0; pj<2; pj++)
+        {
+            double seeds = survival*(s[j] + (1 - s[j])*pj);
+
+            resident[j][pj] = K[j]*seeds*(1 - d[j]);
+            dispersing[j][pj] = K[j]*seeds*(1 - c)*d[j];
+        }
+
+        meanDispersing[j] = P[j]*dispersing[j][1] + (1 - P[j])*dispersing[j][0];
+    }
+
+    for(i=0; i<NPatch; i++)
+    {
+        immigrants[i] = 0;
+
+        for(k=firstSeedSource[i]; k<firstSeedSource[i + 1]; k++)
+        {
+            if(seedSources[k] != i)
+            {
+                immigrants[i] += seedShares[k]*meanDispersing[seedSources[k]];
+            }
+        }
+    }
+
+    /* Ce que les recrues venues de chaque patch emportent : les traits déplacés par la sélection,
+    le taux de consanguinité et l'apparentement de deux recrues du même patch. */
+    for(j=0; j<NPatch; j++)
+    {
+        double selfed = selfedFraction(s[j], P[j]);
+        double w = fitness(j, s[j], d[j], s[j], d[j]);
+
+        /* L'apparentement entre l'individu et ses voisins, rapporté à sa propre parenté avec lui-même. */
+        double r = std::min(2*theta[j]/(1 + inbreeding[j]), 1.0);
+
+        /* Les gradients par différences centrées, pour l'individu puis pour tous ses voisins à la fois. */
+        double h = 1e-6;
+        double sLo = std::max(s[j] - h, 0.0), sHi = std::min(s[j] + h, 1.0);
+        double dLo = std::max(d[j] - h, 0.0), dHi = std::min(d[j] + h, 1.0);
+
+        double gradS = (fitness(j, sHi, d[j], s[j], d[j]) - fitness(j, sLo, d[j], s[j], d[j]))/(sHi - sLo);
+        gradS += r*(fitness(j, s[j], d[j], sHi, d[j]) - fitness(j, s[j], d[j], sLo, d[j]))/(sHi - sLo);
+
+        double gradD = (fitness(j, s[j], dHi, s[j], d[j]) - fitness(j, s[j], dLo, s[j], d[j]))/(dHi - dLo);
+        gradD += r*(fitness(j, s[j], d[j], s[j], dHi) - fitness(j, s[j], d[j], s[j], dLo))/(dHi - dLo);
+
+        /* Les mutations déplacent aussi les moyennes (vers 1/2 sur l'échelle logit, loin des bornes en uniforme)
+        et entretiennent la variance génétique, que l'allofécondation divise par deux à chaque génération :
+        il en reste (1 + selfed)/2, elle s'équilibre donc à 2·taux·(variance d'une mutation)/(1 - selfed). */
+        double sRate = mu*(1 - d_s_relativeMutation), dRate = mu*d_s_relativeMutation;
+        double sShift = 0, sMutation = 0, dShift = 0, dMutation = 0;
+
+        mutationMoments(s[j], sShift, sMutation);
+        mutationMoments(d[j], dShift, dMutation);
+
+        double blending = 1 - std::min(selfed, 0.99);
+        double Vs = 2*sRate*sMutation/blending;
+        double Vd = 2*dRate*dMutation/blending;
+
+        sRecruit[j] = s[j] + sRate*sShift + ((w > 0) ? Vs*gradS/w : 0);
+        dRecruit[j] = d[j] + dRate*dShift + ((w > 0) ? Vd*gradD/w : 0);
+
+        sRecruit[j] = std::min(std::max(sRecruit[j], 0.0), 1.0);
+        dRecruit[j] = std::min(std::max(dRecruit[j], 0.0), 1.0);
+
+        /* Autofécondée : f = 1/2 + f(mère)/2 ; allofécondée : l'apparentement des deux parents. */
+        inbreedingRecruit[j] = selfed*(0.5 + 0.5*inbreeding[j]) + (1 - selfed)*theta[j];
+        fRecruit[j] = relatednessIsManaged ? inbreedingRecruit[j] : 0.5*selfed;
+
+        /* Deux recrues venues du même patch partagent un parent avec la probabilité 1/K. */
+        thetaRecruit[j] = (1 - mitigateRelatedness)*((0.5 + 0.5*inbreeding[j])/K[j] + (1 - 1.0/K[j])*theta[j]);
+    }
+
+    for(i=0; i<NPatch; i++)
+    {
+        double newS = 0, newD = 0, newF = 0, newInbreeding = 0, newTheta = 0, sum = 0;
+
+        /* La part attendue des recrues venues de chaque source, selon la pollinisation du patch et de la source. */
+        for(k=firstSeedSource[i]; k<firstSeedSource[i + 1]; k++)
+        {
+            j = seedSources[k];
+            recruitShare[k - firstSeedSource[i]] = 0;
+
+            for(pi=0; pi<2; pi++)
+            {
+                double probI = pi ? P[i] : 1 - P[i];
+
+                if(j == i)
+                {
+                    double total = resident[i][pi] + immigrants[i];
+                    recruitShare[k - firstSeedSource[i]] += (total > 0) ? probI*resident[i][pi]/total : 0;
+                    continue;
+                }
+
+                for(pj=0; pj<2; pj++)
+                {
+                    double probJ = pj ? P[j] : 1 - P[j];
+                    double arriving = seedShares[k]*dispersing[j][pj];
+                    double total = resident[i][pi] + immigrants[i] + arriving - seedShares[k]*meanDispersing[j];
+
+                    recruitShare[k - firstSeedSource[i]] += (total > 0) ? probI*probJ*arriving/total : 0;
+                }
+            }
+
+            sum += recruitShare[k - firstSeedSource[i]];
+        }
+
+        /* Sans aucune graine, le patch garde ses moyennes. */
+        if(sum <= 0)
+        {
+            continue;
+        }
+
+        for(k=firstSeedSource[i]; k<firstSeedSource[i + 1]; k++)
+        {
+            j = seedSources[k];
+
+            double share = recruitShare[k - firstSeedSource[i]]/sum;
+
+            newS += share*sRecruit[j];
+            newD += share*dRecruit[j];
+            newF += share*fRecruit[j];
+            newInbreeding += share*inbreedingRecruit[j];
+
+            /* Deux recrues venues de patchs différents ne sont pas apparentées. */
+            newTheta += share*share*thetaRecruit[j];
+        }
+
+        change = std::max(change, std::max(std::abs(newS - s[i]), std::abs(newD - d[i])));
+
+        s[i] = newS;
+        d[i] = newD;
+        f[i] = newF;
+        inbreeding[i] = newInbreeding;
+        theta[i] = newTheta;
+    }
+
+    return change;
+}
+
+double MeanField::selfedFraction(double s, double p)
+{
+    double seeds = s + (1 - s)*p;
+
+    return (seeds > 0) ? s/seeds : 1;
+}
+
+double MeanField::lineageInbreeding(double selfed, double theta) const
+{
+    if(relatednessIsManaged)
+    {
+        /* Le point fixe de f = selfed·(1/2 + f/2) + (1 - selfed)·theta. */
+        return (0.5*selfed + (1 - selfed)*theta)/(1 - 0.5*selfed);
+    }
+
+    /* Sans apparentement, une graine autofécondée a f = 1/2, une allofécondée f = 0. */
+    return 0.5*selfed;
+}
+
+double MeanField::seedSurvival(double selfed, double theta, double inbreeding) const
+{
+    /* f_to_delta n'est pas linéaire : la dépression est moyennée sur les individus issus d'autof
+    (f = 1/2 + f(mère)/2, ou 1/2 sans apparentement) et d'allof (f = l'apparentement des parents, ou 0). */
+    double fSelfed = relatednessIsManaged ? 0.5 + 0.5*inbreeding : 0.5;
+    double fOutcrossed = relatednessIsManaged ? theta : 0;
+
+    return 1 - selfed*Individual::f_to_delta(delta, fSelfed) - (1 - selfed)*Individual::f_to_delta(delta, fOutcrossed);
+}
+
+double MeanField::fitness(int j, double sFocal, double dFocal, double sMates, double dMates) const
+{
+    int k = 0, pi = 0, pj = 0;
+    double w = 0;
+
+    /* La dépression de consanguinité de chaque lignée dépend de son taux d'autofécondation. */
+    double focalSelfed = selfedFraction(sFocal, P[j]), matesSelfed = selfedFraction(sMates, P[j]);
+    double focalSurvival = seedSurvival(focalSelfed, theta[j], lineageInbreeding(focalSelfed, theta[j]));
+    double matesSurvival = seedSurvival(matesSelfed, theta[j], lineageInbreeding(matesSelfed, theta[j]));
+
+    for(pj=0; pj<2; pj++)
+    {
+        double probJ = pj ? P[j] : 1 - P[j];
+
+        /* Les graines produites (pour la compétition) et transmises (une autofécondée compte pour un,
+        une allofécondée pour un demi) par l'individu, et les graines produites par ses voisins. */
+        double focalSeeds = focalSurvival*(sFocal + (1 - sFocal)*pj);
+        double focalTransmitted = focalSurvival*(sFocal + 0.5*(1 - sFocal)*pj);
+        double matesSeeds = (K[j] - 1)*matesSurvival*(sMates + (1 - sMates)*pj);
+
+        /* Le noyau est symétrique : les patchs où vont les graines de j sont ceux d'où j reçoit les siennes,
+        avec la même part. Dans chaque patch, les graines de l'individu et de ses voisins remplacent celles du patch j. */
+        for(k=firstSeedSource[j]; k<firstSeedSource[j + 1]; k++)
+        {
+            int i = seedSources[k];
+
+            if(i == j)
+            {
+                double competition = immigrants[j] + (focalSeeds*(1 - dFocal) + matesSeeds*(1 - dMates));
+
+                w += (competition > 0) ? probJ*K[j]*focalTransmitted*(1 - dFocal)/competition : 0;
+                continue;
+            }
+
+            double arriving = seedShares[k]*(1 - c)*(focalSeeds*dFocal + matesSeeds*dMates);
+
+            for(pi=0; pi<2; pi++)
+            {
+                double probI = pi ? P[i] : 1 - P[i];
+                double competition = resident[i][pi] + immigrants[i] - seedShares[k]*meanDispersing[j] + arriving;
+
+                w += (competition > 0) ? probI*probJ*K[i]*seedShares[k]*(1 - c)*focalTransmitted*dFocal/competition : 0;
+            }
+        }
+    }
+
+    return w;
+}
+
+void MeanField::mutationMoments(double trait, double& shift, double& variance) const
+{
+    int k = 0;
+
+    shift = 0;
+    variance = 0;
+
+    switch(typeMut)
+    {
+        case gaussian:
+        {
+            /* Quadrature de Gauss-Hermite à 10 points (nœuds positifs, la règle est symétrique). */
+            static const double nodes[5] = {0.3429013272237046, 1.0366108297895137, 1.7566836492998818,
+                                            2.5327316742327897, 3.4361591188377376};
+            static const double weights[5] = {0.6108626337353258, 0.2401386110823147, 0.03387439445548106,
+                                              0.0013436457467812327, 7.640432855232621e-06};
+
+            for(k=0; k<10; k++)
+            {
+                /* La mutation se fait sur l'échelle logit, comme World::gaussMutation. */
+                double epsilon = std::sqrt(2.0)*sigmaZ*nodes[k/2]*((k%2 == 0) ? 1 : -1);
+                double em1 = std::expm1(epsilon);
+                double mutant = trait*(em1 + 1)/(em1*trait + 1);
+
+                shift += weights[k/2]*(mutant - trait);
+                variance += weights[k/2]*(mutant - trait)*(mutant - trait);
+            }
+
+            shift /= std::sqrt(M_PI);
+            variance /= std::sqrt(M_PI);
+            break;
+        }
+
+        case uniform:
+        {
+            /* Uniforme entre trait - sigmaZ et trait + sigmaZ, bornée à [0, 1], comme World::unifMutation. */
+            double lower = std::max(trait - sigmaZ, 0.0) - trait;
+            double upper = std::min(trait + sigmaZ, 1.0) - trait;
+
+            shift = 0.5*(lower + upper);
+            variance = (upper*upper*upper - lower*lower*lower)/(3*(upper - lower));
+            break;
+        }
+    }
+}
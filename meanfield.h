@@ -0,0 +1,199 @@
+#ifndef MEANFIELD_H_INCLUDED
+#define MEANFIELD_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <ostream>
+
+#include "driver.h"
+#include "options.h"
+#include "world.h"
+
+/**
+ * @file
+ */
+
+/**
+ * @brief
+ * Le modèle en champ moyen : la dynamique attendue des moyennes de s, de d et de f dans chaque patch,
+ * sans tirage aléatoire. Il sert à classer les points d'un balayage, avant de lancer les simulations complètes :
+ * ses équilibres s'écartent nettement de ceux de World (s sous-estimé de 0,15 à 0,2, d écarté jusqu'à 0,07
+ * sur les cas comparés), seul l'ordre des points est fiable.
+ *
+ * Le paysage (K, P et les patchs d'où viennent les graines) est construit comme dans World,
+ * et les pressions en propagules suivent les mêmes formules que Patch. À chaque itération (une génération) :
+ *      - chaque patch reçoit ses recrues des patchs sources en proportion de leurs pressions,
+ *        en moyenne sur la pollinisation du patch et de la source ;
+ *      - les recrues venues d'un patch portent la moyenne de ce patch, déplacée par la sélection :
+ *        variance génétique × gradient de la valeur sélective inclusive d'un individu du patch
+ *        (ses recrues, dans son patch et dans les patchs à portée, plus l'effet de ses voisins
+ *        pondéré par leur apparentement : la compétition entre apparentés est prise en compte).
+ *        Une graine autofécondée transmet tous les traits de sa mère, une graine allofécondée la moitié ;
+ *      - f et l'apparentement moyen entre deux individus du patch suivent leurs récurrences attendues.
+ *
+ * Les mutations déplacent aussi les moyennes, avec la même loi que dans World. La variance génétique
+ * de chaque trait est celle qu'entretiennent les mutations face au mélange des allofécondations.
+ * Elle fixe la vitesse de la dynamique (une itération suit à peu près une génération de World) et,
+ * dans un paysage hétérogène, l'équilibre entre sélection locale et flux de graines :
+ * les valeurs obtenues sont approchées.
+ * Le shift de l'aire de répartition n'est pas modélisé, ni les apparentements entre patchs.
+ */
+
+class MeanField
+{
+public:
+
+    /**
+     * @brief
+     * Constructeur : construit le paysage et place tous les patchs aux traits initiaux.
+     *
+     * @param params    Les paramètres du monde (les mêmes que pour World)
+     * @param options   Les réglages facultatifs (forme de la grille, noyau de dispersion, itérations)
+     */
+    MeanField(const Parameters& params, const Options& options);
+
+    /**
+     * @brief
+     * Méthode qui itère la dynamique jusqu'à l'équilibre ou jusqu'au nombre maximal d'itérations.
+     *
+     * @return  Vrai si l'équilibre est atteint
+     */
+    bool solve(void);
+
+    /** @brief Le nombre d'itérations effectuées */
+    int iterations(void) const;
+
+    /** @brief La moyenne, sur les patchs, des moyennes de s */
+    double meanS(void) const;
+
+    /** @brief La moyenne, sur les patchs, des moyennes de d */
+    double meanD(void) const;
+
+    /** @brief La moyenne, sur les patchs, des moyennes de f */
+    double meanF(void) const;
+
+    /**
+     * @brief
+     * Méthode qui écrit une ligne par patch : le point, le patch, sa colonne, sa ligne, K, P, s, d et f.
+     *
+     * @param out       Le flux où écrire
+     * @param point     Le numéro du point, en première colonne
+     */
+    void writePatches(std::ostream& out, int point) const;
+
+private:
+
+    int NPatch; /**< @brief Le nombre de patchs */
+    int columns; /**< @brief Le nombre de colonnes de patchs */
+    int rows; /**< @brief Le nombre de lignes de patchs (1 pour une chaîne) */
+
+    double delta; /**< @brief La dépression de consanguinité */
+    double c; /**< @brief Le coût de la dispersion */
+    bool relatednessIsManaged; /**< @brief Si l'apparentement est géré */
+    double mitigateRelatedness; /**< @brief La diminution de l'apparentement à chaque génération */
+
+    distrMut typeMut; /**< @brief La distribution de l'ampleur de mutation */
+    double mu; /**< @brief La probabilité de mutation */
+    double sigmaZ; /**< @brief L'ampleur de la mutation */
+    double d_s_relativeMutation; /**< @brief La part des mutations qui touchent d */
+
+    int maxIterations; /**< @brief Le nombre maximal d'itérations */
+    double tolerance; /**< @brief La variation maximale d'une moyenne à l'équilibre */
+    int iterationCount; /**< @brief Le nombre d'itérations effectuées */
+
+    std::vector<int> K; /**< @brief La capacité d'accueil de chaque patch */
+    std::vector<double> P; /**< @brief La probabilité de pollinisation de chaque patch */
+
+    std::vector<int> seedSources; /**< @brief Les patchs sources de chaque patch (voir World::buildSeedSources) */
+    std::vector<double> seedShares; /**< @brief La part de chaque source */
+    std::vector<int> firstSeedSource; /**< @brief La position des sources de chaque patch */
+
+    std::vector<double> s; /**< @brief La moyenne de s de chaque patch */
+    std::vector<double> d; /**< @brief La moyenne de d de chaque patch */
+    std::vector<double> f; /**< @brief La moyenne de f de chaque patch */
+    std::vector<double> theta; /**< @brief L'apparentement moyen entre deux individus de chaque patch */
+
+    /**
+     * @brief
+     * Le taux de consanguinité généalogique de chaque patch, pour l'apparentement entre voisins.
+     * C'est f quand l'apparentement est géré ; sinon, le modèle ne retient que f = 1/2 après une autofécondation.
+     */
+    std::vector<double> inbreeding;
+
+    /* Les vecteurs de travail d'une itération */
+    std::vector<std::array<double, 2>> resident; /**< @brief Les pressions résidentes de chaque patch, non pollinisé puis pollinisé */
+    std::vector<std::array<double, 2>> dispersing; /**< @brief Les pressions dispersantes de chaque patch, non pollinisé puis pollinisé */
+    std::vector<double> meanDispersing; /**< @brief Les pressions dispersantes attendues de chaque patch */
+    std::vector<double> immigrants; /**< @brief Les graines dispersantes attendues qui arrivent dans chaque patch */
+    std::vector<double> recruitShare; /**< @brief La part attendue des recrues venues de chaque source d'un patch */
+
+    std::vector<double> sRecruit; /**< @brief Le s moyen des recrues venues de chaque patch */
+    std::vector<double> dRecruit; /**< @brief Le d moyen des recrues venues de chaque patch */
+    std::vector<double> fRecruit; /**< @brief Le f moyen des recrues venues de chaque patch */
+    std::vector<double> inbreedingRecruit; /**< @brief La consanguinité généalogique des recrues venues de chaque patch */
+    std::vector<double> thetaRecruit; /**< @brief L'apparentement de deux recrues venues du même patch */
+
+    /**
+     * @brief
+     * Méthode qui calcule la génération suivante.
+     *
+     * @return  La plus grande variation d'une moyenne de s ou de d
+     */
+    double step(void);
+
+    /**
+     * @brief
+     * La part des graines d'un patch issues d'autofécondation.
+     *
+     * @param s     Le taux d'autofécondation
+     * @param p     La probabilité de pollinisation du patch
+     */
+    static double selfedFraction(double s, double p);
+
+    /**
+     * @brief
+     * Le taux de consanguinité à l'équilibre d'une lignée qui produit une part selfed de graines autofécondées.
+     *
+     * @param selfed    La part de graines autofécondées
+     * @param theta     L'apparentement moyen entre deux individus du patch
+     */
+    double lineageInbreeding(double selfed, double theta) const;
+
+    /**
+     * @brief
+     * La part des graines épargnée par la dépression de consanguinité, en moyenne sur les individus
+     * issus d'autofécondation et d'allofécondation.
+     *
+     * @param selfed        La part des individus issus d'autofécondation
+     * @param theta         L'apparentement moyen entre deux individus du patch
+     * @param inbreeding    Le taux de consanguinité généalogique des mères
+     */
+    double seedSurvival(double selfed, double theta, double inbreeding) const;
+
+    /**
+     * @brief
+     * La valeur sélective d'un individu du patch j : ses recrues attendues, dans son patch et dans les patchs
+     * à portée, comptées pour un si elles sont autofécondées et pour un demi sinon.
+     * L'espérance porte sur la pollinisation du patch j et du patch d'arrivée ; les autres sources
+     * y envoient leurs graines attendues.
+     *
+     * @param j             Le patch de l'individu
+     * @param sFocal        Le taux d'autofécondation de l'individu
+     * @param dFocal        Le taux de dispersion de l'individu
+     * @param sMates        Le taux d'autofécondation des autres individus du patch
+     * @param dMates        Le taux de dispersion des autres individus du patch
+     */
+    double fitness(int j, double sFocal, double dFocal, double sMates, double dMates) const;
+
+    /**
+     * @brief
+     * Les deux premiers moments de l'effet d'une mutation sur un trait : le déplacement moyen et le carré moyen.
+     *
+     * @param trait     La valeur du trait avant la mutation
+     * @param shift     Reçoit le déplacement moyen
+     * @param variance  Reçoit le carré moyen du déplacement
+     */
+    void mutationMoments(double trait, double& shift, double& variance) const;
+};
+
+#endif // MEANFIELD_H_INCLUDED
@@ -0,0 +1,297 @@
+#include <string>
+#include <sstream>
+
+#include "options.h"
+#include "dispersal.h"
+
+Options::Options(void)
+{
+    threads = 1;
+
+    seedIsSet = false;
+    seed = 0;
+
+    reportFormat = textReport;
+    histogramBins = 10;
+    reportPrecision = quantized;
+    reportCompression = false;
+
+    asyncWriter = true;
+
+    hugePages = false;
+
+    relatednessBand = -1;
+    bandBackground = zeroBackground;
+
+    kinshipMode = exactKinship;
+    pedigreeDepth = 30;
+    kinshipSamples = 200;
+    kinshipError = 0.02;
+
+    relationFormat = textRelation;
+    dumpFrequency = 0;
+
+    width = 0;
+    neighbours = 4;
+
+    kernel = nearestKernel;
+    kernelScale = 1;
+    kernelRange = 5;
+
+    checkpointFrequency = 0;
+    resume = false;
+
+    profileFrequency = 0;
+
+    progress = true;
+
+    workers = 0;
+    memory = 0;
+
+    targetHalfWidth = 0;
+    minReplicates = 3;
+
+    meanFieldIterations = 10000000;
+    meanFieldTolerance = 1e-10;
+}
+
+bool Options::parse(const std::string& arg)
+{
+    size_t sep = arg.find('=');
+
+    if(sep == std::string::npos)
+    {
+        return false;
+    }
+
+    std::string key = arg.substr(0, sep);
+    std::istringstream value(arg.substr(sep + 1));
+
+    if(key == "threads")
+    {
+        return bool(value >> threads) && threads >= 0;
+    }
+
+    if(key == "seed")
+    {
+        seedIsSet = bool(value >> seed);
+        return seedIsSet;
+    }
+
+    if(key == "report")
+    {
+        if(value.str() == "text")
+        {
+            reportFormat = textReport;
+            return true;
+        }
+        if(value.str() == "binary")
+        {
+            reportFormat = binaryReport;
+            return true;
+        }
+        if(value.str() == "summary")
+        {
+            reportFormat = summaryReport;
+            return true;
+        }
+        return false;
+    }
+
+    if(key == "bins")
+    {
+        return bool(value >> histogramBins) && histogramBins > 0;
+    }
+
+    if(key == "precision")
+    {
+        if(value.str() == "uint16")
+        {
+            reportPrecision = quantized;
+            return true;
+        }
+        if(value.str() == "float")
+        {
+            reportPrecision = simple;
+            return true;
+        }
+        return false;
+    }
+
+    if(key == "compress")
+    {
+        return bool(value >> reportCompression);
+    }
+
+    if(key == "writer")
+    {
+        if(value.str() == "async" || value.str() == "sync")
+        {
+            asyncWriter = (value.str() == "async");
+            return true;
+        }
+        return false;
+    }
+
+    if(key == "hugepages")
+    {
+        return bool(value >> hugePages);
+    }
+
+    if(key == "band")
+    {
+        return bool(value >> relatednessBand) && relatednessBand >= -1;
+    }
+
+    if(key == "background")
+    {
+        if(value.str() == "zero")
+        {
+            bandBackground = zeroBackground;
+            return true;
+        }
+        if(value.str() == "mean")
+        {
+            bandBackground = meanBackground;
+            return true;
+        }
+        return false;
+    }
+
+    if(key == "kinship")
+    {
+        if(value.str() == "exact")
+        {
+            kinshipMode = exactKinship;
+            return true;
+        }
+        if(value.str() == "pedigree")
+        {
+            kinshipMode = pedigreeKinship;
+            return true;
+        }
+        return false;
+    }
+
+    if(key == "depth")
+    {
+        return bool(value >> pedigreeDepth) && pedigreeDepth >= 1;
+    }
+
+    if(key == "samples")
+    {
+        return bool(value >> kinshipSamples) && kinshipSamples >= 1;
+    }
+
+    if(key == "error")
+    {
+        return bool(value >> kinshipError) && kinshipError >= 0;
+    }
+
+    if(key == "relation")
+    {
+        if(value.str() == "text")
+        {
+            relationFormat = textRelation;
+            return true;
+        }
+        if(value.str() == "binary")
+        {
+            relationFormat = binaryRelation;
+            return true;
+        }
+        return false;
+    }
+
+    if(key == "dump")
+    {
+        return bool(value >> dumpFrequency) && dumpFrequency >= 0;
+    }
+
+    if(key == "width")
+    {
+        return bool(value >> width) && width >= 0;
+    }
+
+    if(key == "neighbours")
+    {
+        return bool(value >> neighbours) && (neighbours == 4 || neighbours == 8);
+    }
+
+    if(key == "kernel")
+    {
+        int type = 0;
+
+        for(type=nearestKernel; type<=geometricKernel; type++)
+        {
+            if(value.str() == DispersalKernel::name(dispersalKernel(type)))
+            {
+                kernel = dispersalKernel(type);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if(key == "scale")
+    {
+        return bool(value >> kernelScale) && kernelScale > 0;
+    }
+
+    if(key == "range")
+    {
+        return bool(value >> kernelRange) && kernelRange >= 1;
+    }
+
+    if(key == "checkpoint")
+    {
+        return bool(value >> checkpointFrequency) && checkpointFrequency >= 0;
+    }
+
+    if(key == "profile")
+    {
+        return bool(value >> profileFrequency) && profileFrequency >= 0;
+    }
+
+    if(key == "resume")
+    {
+        return bool(value >> resume);
+    }
+
+    if(key == "progress")
+    {
+        return bool(value >> progress);
+    }
+
+    if(key == "workers")
+    {
+        return bool(value >> workers) && workers >= 0;
+    }
+
+    if(key == "memory")
+    {
+        return bool(value >> memory) && memory >= 0;
+    }
+
+    if(key == "ci")
+    {
+        return bool(value >> targetHalfWidth) && targetHalfWidth >= 0;
+    }
+
+    if(key == "min")
+    {
+        return bool(value >> minReplicates) && minReplicates >= 2;
+    }
+
+    if(key == "iterations")
+    {
+        return bool(value >> meanFieldIterations) && meanFieldIterations > 0;
+    }
+
+    if(key == "tolerance")
+    {
+        return bool(value >> meanFieldTolerance) && meanFieldTolerance > 0;
+    }
+
+    return false;
+}
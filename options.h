@@ -0,0 +1,206 @@
+#ifndef OPTIONS_H_INCLUDED
+#define OPTIONS_H_INCLUDED
+
+#include <string>
+#include <cstdint>
+
+#include "binary_report.h"
+#include "relatedness.h"
+#include "dispersal.h"
+
+/**
+ * @file
+ */
+
+/** @brief Énumération qui permet de choisir le format du rapport. */
+typedef enum _reportFormat_
+{
+    textReport = 0,     /**< report_<id>.txt, une ligne par individu */
+    binaryReport = 1,   /**< report_<id>.bin, en colonnes (voir binary_report.h) */
+    summaryReport = 2,  /**< report_<id>.txt, une ligne par patch : moyenne, variance, min, max et histogramme (voir summary_report.h) */
+} formatReport;
+
+/** @brief Énumération qui permet de choisir comment les apparentements sont obtenus quand ils sont gérés. */
+typedef enum _kinshipMode_
+{
+    exactKinship = 0,       /**< La matrice d'apparentement, recalculée à chaque génération */
+    pedigreeKinship = 1,    /**< Estimés à la demande dans la généalogie des dernières générations (voir pedigree.h) */
+} modeKinship;
+
+/** @brief Énumération qui permet de choisir le format de la matrice d'apparentement finale. */
+typedef enum _relationFormat_
+{
+    textRelation = 0,   /**< relation_<id>.txt, en texte */
+    binaryRelation = 1, /**< relation_<id>.bin, le triangle brut (voir relatedness_dump.h) */
+} formatRelation;
+
+/**
+ * @brief
+ * Contient les réglages facultatifs d'une simulation.
+ *
+ * Ils sont donnés après les paramètres du modèle sur la ligne de commande,
+ * sous la forme cle=valeur (par exemple threads=8).
+ * Tous ont une valeur par défaut qui reproduit le fonctionnement habituel.
+ */
+
+class Options
+{
+public:
+
+    Options(void);
+
+    /** @brief Le nombre de threads pour créer une génération (0 = autant que de coeurs). */
+    int threads;
+
+    /** @brief Vrai si la graine est imposée, sinon elle est tirée de l'horloge. */
+    bool seedIsSet;
+
+    /** @brief La graine imposée du monde. */
+    std::uint64_t seed;
+
+    /** @brief Le format du rapport (report=text, report=binary ou report=summary). */
+    formatReport reportFormat;
+
+    /** @brief Le nombre de classes des histogrammes du rapport résumé (bins=N). */
+    int histogramBins;
+
+    /** @brief Le stockage des traits dans le rapport binaire (precision=uint16 ou precision=float). */
+    precisionReport reportPrecision;
+
+    /** @brief Si les colonnes du rapport binaire sont compressées (compress=1). */
+    bool reportCompression;
+
+    /**
+     * @brief
+     * Si les rapports et le journal de pollinisation sont écrits par un thread à part
+     * (writer=async, par défaut) ou directement par la simulation (writer=sync).
+     * Le contenu des fichiers est le même.
+     */
+    bool asyncWriter;
+
+    /** @brief Si les matrices d'apparentement demandent des pages de grande taille au système (hugepages=1). */
+    bool hugePages;
+
+    /**
+     * @brief La distance (en patchs) des paires dont l'apparentement est suivi (band=D).
+     *
+     * -1 (par défaut) : toutes les paires, dans une demi-matrice complète.
+     * Sinon, seules les paires à au plus D patchs l'une de l'autre sont stockées.
+     */
+    int relatednessBand;
+
+    /** @brief L'apparentement des paires hors de la bande, ou au-delà de la généalogie (background=zero ou background=mean). */
+    backgroundBand bandBackground;
+
+    /**
+     * @brief
+     * Comment les apparentements sont obtenus (kinship=exact ou kinship=pedigree).
+     *
+     * Avec kinship=pedigree, il n'y a plus de matrice : f des descendants allofécondés est estimé
+     * en remontant la généalogie des depth=N dernières générations (30 par défaut),
+     * avec au plus samples=N paires de lignées (200 par défaut), en s'arrêtant dès que
+     * l'erreur type passe sous error=X (0.02 par défaut, 0 pour toujours faire samples tirages,
+     * sans le léger biais vers le bas que donne l'arrêt anticipé, voir Pedigree::kinship).
+     * background= donne la valeur des lignées encore séparées au-delà de la généalogie.
+     * Ni band= ni la matrice finale (relation=, dump=) ne s'appliquent alors.
+     */
+    modeKinship kinshipMode;
+
+    /** @brief Le nombre de générations gardées dans la généalogie (depth=N). */
+    int pedigreeDepth;
+
+    /** @brief Le nombre maximal de paires de lignées tirées par apparentement estimé (samples=N). */
+    int kinshipSamples;
+
+    /** @brief L'erreur type visée pour un apparentement estimé (error=X). */
+    double kinshipError;
+
+    /** @brief Le format de la matrice d'apparentement finale (relation=text ou relation=binary). */
+    formatRelation relationFormat;
+
+    /**
+     * @brief
+     * Toutes les combien de générations la matrice d'apparentement est aussi écrite
+     * en binaire dans relation_<id>_<génération>.bin (dump=N, 0 = jamais).
+     */
+    int dumpFrequency;
+
+    /**
+     * @brief Le nombre de colonnes de patchs (width=W).
+     *
+     * 0 (par défaut) : les patchs forment une chaîne.
+     * Sinon, ils forment une grille de W colonnes et NPatch/W lignes (NPatch doit être un multiple de W).
+     */
+    int width;
+
+    /** @brief Le nombre de patchs voisins sur une grille, qui reçoivent les graines dispersantes (neighbours=4 ou neighbours=8). */
+    int neighbours;
+
+    /**
+     * @brief La répartition des graines dispersantes avec la distance
+     * (kernel=nearest, par défaut, kernel=exponential, kernel=cauchy ou kernel=geometric, voir dispersal.h).
+     */
+    dispersalKernel kernel;
+
+    /** @brief L'échelle du noyau de dispersion, en patchs (scale=X, 1 par défaut ; au moins 1 pour kernel=geometric). */
+    double kernelScale;
+
+    /** @brief La distance maximale de dispersion, en patchs (range=R, 5 par défaut ; sans effet pour kernel=nearest). */
+    int kernelRange;
+
+    /** @brief Le nombre de générations entre deux instantanés (checkpoint=N, 0 = aucun instantané). */
+    int checkpointFrequency;
+
+    /** @brief Si le monde reprend à partir de son instantané checkpoint_<id>.bin quand il existe (resume=1). */
+    bool resume;
+
+    /**
+     * @brief
+     * Le nombre de générations entre deux lignes de profile_series_<id>.txt (profile=N, 0 = pas de série).
+     * Sans effet si le programme n'est pas compilé avec -DPLANTS_PROFILE.
+     */
+    int profileFrequency;
+
+    /** @brief Si la progression doit être affichée à l'écran. */
+    bool progress;
+
+    /** @brief En mode --sweep, le nombre de mondes simulés en même temps (0 = autant que de coeurs). */
+    int workers;
+
+    /** @brief En mode --sweep, la mémoire disponible en Go (0 = 90% de la mémoire physique). */
+    double memory;
+
+    /**
+     * @brief
+     * En mode --sweep, la demi-largeur visée de l'intervalle de confiance à 95 % des moyennes finales
+     * de s et de d sur les réplicats d'un point (ci=W). Les réplicats sont alors lancés peu à peu
+     * et s'arrêtent dès que la cible est atteinte, le nombre de réplicats donné devenant un plafond.
+     * 0 (par défaut) : tous les réplicats sont simulés.
+     */
+    double targetHalfWidth;
+
+    /** @brief En mode --sweep avec ci=W, le nombre minimal de réplicats d'un point (min=N, 3 par défaut). */
+    int minReplicates;
+
+    /** @brief En mode --meanfield, le nombre maximal d'itérations par point (iterations=N). */
+    int meanFieldIterations;
+
+    /**
+     * @brief
+     * En mode --meanfield, l'équilibre est atteint quand plus aucune moyenne de s ou de d
+     * ne varie de plus de tolerance=X en une itération.
+     */
+    double meanFieldTolerance;
+
+    /**
+     * @brief
+     * Méthode qui lit un réglage de la forme cle=valeur.
+     *
+     * @param arg   L'argument de la ligne de commande
+     *
+     * @return      Vrai si le réglage est connu et sa valeur valide, faux sinon.
+     */
+    bool parse(const std::string& arg);
+};
+
+#endif // OPTIONS_H_INCLUDED
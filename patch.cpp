@@ -4,236 +4,106 @@
 
 #include "patch.h"
 #include "individual.h"
+#include "population.h"
+#include "convergence.h"
+#include "alias_sampler.h"
 
-Patch::Patch(double p, int K, double sInit, double dInit, int pos_of_first_ind)
+Patch::Patch(double p, int K, int pos_of_first_ind)
 {
-    int i = 0;
-
     this->p = p;
     this->K = K;
 
     this->pos_of_first_ind = pos_of_first_ind;
 
-    /* La ligne suivante permet de réserver
-    de la mémoire pour éviter les réallocations
-    qui peuvent diminuer les performances. */
-    population.reserve(K);
-
-    for(i=0; i<K; i++)
-    {
-        /* On initialise des individus non consanguins. */
-        population.emplace_back(sInit, dInit, 0);
-    }
+    pollenized = false;
 
-    d_hasConverged = false;
-    s_hasConverged = false;
+    dispSeeds.reserve(2*K);
+    dispSampler.reserve(2*K);
 
-    previous_d_means = {0,0};
-    previous_s_means = {0,0};
+    sumS = 0;
+    sumD = 0;
 }
 
-void Patch::getDispPress(double delta, double c, std::vector<double>& press)
+void Patch::updateDispSeeds(const Population& population, double delta, double c)
 {
-    if(dispSeeds.empty()) //Si le vecteur est vide, il faut le remplir.
-    {
-        int i = 0;
+    int i = 0;
+    int n = population.size();
 
-        dispSeeds.reserve(2*population.size());
-        for(i=0; i < population.size(); i++)
-        {
-            population[i].calcDispPress(delta, c, pollenized, dispSeeds);
-        }
-    }
+    /* Les pressions allof sont nulles si le patch n'est pas pollinisé. */
+    double allof = pollenized ? 1 : 0;
 
-    press.insert(press.end(), dispSeeds.begin(), dispSeeds.end());
-}
+    const double* s = population.s.data();
+    const double* d = population.d.data();
+    const double* f = population.f.data();
 
-void Patch::getResidPress(double delta, std::vector<double>& press)
-{
-    int i = 0;
+    /* Les pressions autof (paires) et allof (impaires) sont entrelacées. */
+    dispSeeds.resize(2*n);
+    double* seeds = dispSeeds.data();
 
-    for(i=0; i < population.size(); i++)
+    for(i=0; i<n; i++)
     {
-        population[i].calcResidPress(delta, pollenized, press);
+        double ind_delta = Individual::f_to_delta(delta, f[i]);
+        double common = (1 - ind_delta)*(1 - c)*d[i];
+
+        seeds[2*i] = s[i]*common;
+        seeds[2*i + 1] = allof*(1 - s[i])*common;
     }
+
+    dispSampler.build(dispSeeds);
 }
 
-int Patch::check_convergence(int checkCount, int NGenToConverge, int n_choose_2, double relativeConvergence, double absoluteConvergence)
+void Patch::getResidPress(const Population& population, double delta, std::vector<double>& press)
 {
     int i = 0;
+    int n = population.size();
+    int first = press.size();
 
-    std::vector<double> trait_values;
-
-    trait_values.reserve(K);
-
-    /* Avant d'avoir suffisamment de générations de référence, on remplit la matrice. */
-    if(checkCount < NGenToConverge)
-    {
-        /* Pour d */
-        for(i=0; i<K; i++)
-        {
-            trait_values.push_back(population[i].d);
-        }
-
-        double new_d_mean = calc_mean(trait_values);
-
-        for(i=0; i<checkCount; i++)
-        {
-            prev_gens_d_similarity_matrix[i][NGenToConverge - checkCount - 1] =
-            check_stats(previous_d_means[i], new_d_mean, relativeConvergence, absoluteConvergence);
-        }
-
-        previous_d_means[checkCount] = new_d_mean;
-
-        trait_values.clear();
+    double allof = pollenized ? 1 : 0;
 
-        /* Pour s */
-        for(i=0; i<K; i++)
-        {
-            trait_values.push_back(population[i].s);
-        }
+    const double* s = population.s.data();
+    const double* d = population.d.data();
+    const double* f = population.f.data();
 
-        double new_s_mean = calc_mean(trait_values);
+    press.resize(first + 2*n);
+    double* resid = press.data() + first;
 
-        for(i=0; i<checkCount; i++)
-        {
-            prev_gens_s_similarity_matrix[i][NGenToConverge - checkCount - 1] =
-            check_stats(previous_s_means[i], new_s_mean, relativeConvergence, absoluteConvergence);
-        }
-
-        previous_s_means[checkCount] = new_s_mean;
-    }
-
-    /* D'une fois que la matrice est remplie, on peut vérifier la convergence. */
-    else
+    for(i=0; i<n; i++)
     {
-        int j = 0;
-        int convergeSum = 0;
-
-        /* Pour d */
-        if(!d_hasConverged)
-        {
-            /* On vérifie que ce trait a convergé. */
-            for(i=0; i<(NGenToConverge - 1); i++)
-            {
-                for(j=0; j<(NGenToConverge - 1 - i); j++)
-                {
-                    convergeSum += prev_gens_d_similarity_matrix[i][j];
-                }
-            }
-
-            if(convergeSum == n_choose_2)
-            {
-                d_hasConverged = 1;
-            }
-
-            else
-            {
-                for(i=0; i<K; i++)
-                {
-                    trait_values.push_back(population[i].d);
-                }
-
-                double new_d_mean = calc_mean(trait_values);
-
-                while(i < checkCount%NGenToConverge)
-                {
-                    prev_gens_d_similarity_matrix[i][NGenToConverge - 1 - checkCount%NGenToConverge] =
-                    check_stats(previous_d_means[i], new_d_mean, relativeConvergence, absoluteConvergence);
-                    i++;
-                }
-
-                for(i=0; i < NGenToConverge - 1 - checkCount%NGenToConverge; i++)
-                {
-                    prev_gens_d_similarity_matrix[checkCount%NGenToConverge][i] =
-                    check_stats(previous_d_means[NGenToConverge - 1 - i], new_d_mean, relativeConvergence, absoluteConvergence);
-                }
-
-                previous_d_means[checkCount%NGenToConverge] = new_d_mean;
-
-                trait_values.clear();
-
-            }
-        }
-
-        /* Pour s */
-        if(!s_hasConverged)
-        {
-            /* On vérifie que ce trait a convergé. */
-            convergeSum = 0;
-
-            for(i=0; i<(NGenToConverge - 1); i++)
-            {
-                for(j=0; j<(NGenToConverge - 1 - i); j++)
-                {
-                    convergeSum += prev_gens_s_similarity_matrix[i][j];
-                }
-            }
-
-            if(convergeSum == n_choose_2)
-            {
-                s_hasConverged = 1;
-            }
-
-            else
-            {
-                for(i=0; i<K; i++)
-                {
-                    trait_values.push_back(population[i].s);
-                }
-
-                double new_s_mean = calc_mean(trait_values);
-
-                while(i < checkCount%NGenToConverge)
-                {
-                    prev_gens_s_similarity_matrix[i][NGenToConverge - 1 - checkCount%NGenToConverge] =
-                    check_stats(previous_s_means[i], new_s_mean, relativeConvergence, absoluteConvergence);
-                    i++;
-                }
-
-                for(i=0; i < NGenToConverge - 1 - checkCount%NGenToConverge; i++)
-                {
-                    prev_gens_s_similarity_matrix[checkCount%NGenToConverge][i] =
-                    check_stats(previous_s_means[NGenToConverge - 1 - i], new_s_mean, relativeConvergence, absoluteConvergence);
-                }
-
-                previous_s_means[checkCount%NGenToConverge] = new_s_mean;
-            }
-        }
-
-        if(d_hasConverged && s_hasConverged)
-        {
-            return 1; //Le patch a convergé, on renvoie 1 pour sommer tous les patchs convergés.
-        }
-    }
+        double ind_delta = Individual::f_to_delta(delta, f[i]);
+        double common = (1 - ind_delta)*(1 - d[i]);
 
-    return 0;
+        resid[2*i] = s[i]*common;
+        resid[2*i + 1] = allof*(1 - s[i])*common;
+    }
 }
 
-bool Patch::check_stats(double first_mean, double second_mean, double relativeConvergence, double absoluteConvergence)
+void Patch::updateSums(const Population& population)
 {
-    /* On a deux critères avec un OU logique
-    En variation relative: efficace quand la valeur est haute
-    En variation absolue: efficace quand la valeur est basse */
-    if(std::abs(first_mean - second_mean)/second_mean < relativeConvergence ||
-       (std::abs(first_mean - second_mean) < absoluteConvergence))
+    int i = 0;
+    int n = population.size();
+
+    sumS = 0;
+    sumD = 0;
+
+    for(i=0; i<n; i++)
     {
-        return true;
+        sumS += population.s[i];
+        sumD += population.d[i];
     }
-
-    return false;
 }
 
-double Patch::calc_mean(std::vector<double> values)
+int Patch::check_convergence(double relativeConvergence, double absoluteConvergence)
 {
-    int i = 0;
+    /* Après chaque génération, le patch compte exactement K individus. */
+    double n = K;
 
-    double sum = 0;
+    bool d_hasConverged = dConvergence.add(sumD/n, relativeConvergence, absoluteConvergence);
+    bool s_hasConverged = sConvergence.add(sumS/n, relativeConvergence, absoluteConvergence);
 
-    for(i=0; i<int(values.size()); i++)
+    if(d_hasConverged && s_hasConverged)
     {
-        sum += values[i];
+        return 1; //Le patch a convergé, on renvoie 1 pour sommer tous les patchs convergés.
     }
 
-    return sum/values.size();
+    return 0;
 }
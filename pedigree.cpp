@@ -0,0 +1,261 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+#include "pedigree.h"
+#include "rng.h"
+#include "checkpoint.h"
+
+Pedigree::Pedigree(void)
+{
+    depth = 1;
+    n = 0;
+    scale = 1;
+    backgroundType = zeroBackground;
+
+    newest = 0;
+    generations = 0;
+}
+
+void Pedigree::allocate(int depth, const std::vector<int>& firstOfPatch, double mitigate, backgroundBand background)
+{
+    this->depth = depth;
+    this->firstOfPatch = firstOfPatch;
+    n = firstOfPatch.back();
+    scale = 1 - mitigate;
+    backgroundType = background;
+
+    newest = 0;
+    generations = 0;
+
+    /* Les fondateurs n'ont pas de parents connus. */
+    mothers.assign(std::size_t(depth)*n, -1);
+    fathers.assign(std::size_t(depth)*n, -1);
+    inbreeding.assign(std::size_t(depth)*n, 0);
+    this->background.assign(std::size_t(depth)*firstOfPatch.size(), 0);
+}
+
+int Pedigree::levels(void) const
+{
+    return std::min(generations + 1, depth);
+}
+
+void Pedigree::push(const std::vector<int>& mothers, const std::vector<int>& fathers)
+{
+    newest = (newest + 1)%depth;
+    generations ++;
+
+    std::copy(mothers.begin(), mothers.begin() + n, this->mothers.begin() + slot(0));
+    std::copy(fathers.begin(), fathers.begin() + n, this->fathers.begin() + slot(0));
+}
+
+void Pedigree::updateBackground(RandomEngine& gen, int samples)
+{
+    int p = 0, k = 0;
+    int NPatch = int(firstOfPatch.size()) - 1;
+    double* mean = background.data() + std::size_t(newest)*(NPatch + 1);
+    double sum = 0;
+
+    if(backgroundType == zeroBackground)
+    {
+        return;
+    }
+
+    for(p=0; p<NPatch; p++)
+    {
+        int K = firstOfPatch[p + 1] - firstOfPatch[p];
+
+        sum = 0;
+        mean[p] = 0;
+
+        if(K < 2)
+        {
+            continue;
+        }
+
+        std::uniform_int_distribution<int> first(0, K - 1), second(0, K - 2);
+
+        /* Une paire de lignées par paire d'individus distincts : la moyenne reste sans biais. */
+        for(k=0; k<samples; k++)
+        {
+            int i = first(gen);
+            int j = second(gen);
+
+            if(j >= i)
+            {
+                j ++;
+            }
+
+            sum += sampleLineages(firstOfPatch[p] + i, firstOfPatch[p] + j, gen);
+        }
+
+        mean[p] = sum/samples;
+    }
+
+    /* Puis deux individus de patchs différents. */
+    std::uniform_int_distribution<int> anyone(0, n - 1);
+
+    sum = 0;
+    mean[NPatch] = 0;
+
+    if(NPatch < 2)
+    {
+        return;
+    }
+
+    for(k=0; k<samples; k++)
+    {
+        int i = anyone(gen);
+        int j = anyone(gen);
+
+        while(patchOf(j) == patchOf(i))
+        {
+            j = anyone(gen);
+        }
+
+        sum += sampleLineages(i, j, gen);
+    }
+
+    mean[NPatch] = sum/samples;
+}
+
+int Pedigree::patchOf(int i) const
+{
+    return std::upper_bound(firstOfPatch.begin(), firstOfPatch.end(), i) - firstOfPatch.begin() - 1;
+}
+
+double Pedigree::horizon(int i, int j) const
+{
+    if(backgroundType == zeroBackground)
+    {
+        return 0;
+    }
+
+    int p = patchOf(i);
+    int NPatch = int(firstOfPatch.size()) - 1;
+    const double* mean = background.data() + std::size_t((newest - (levels() - 1) + depth)%depth)*(NPatch + 1);
+
+    /* La moyenne du patch, ou celle de deux individus de patchs différents. */
+    return patchOf(j) == p ? mean[p] : mean[NPatch];
+}
+
+double Pedigree::identity(int level, int i) const
+{
+    /* La diagonale de la première matrice vaut 1/2, sans diminution. */
+    if(level == generations)
+    {
+        return 0.5;
+    }
+
+    return scale*(0.5 + 0.5*inbreeding[slot(level) + i]);
+}
+
+double Pedigree::sampleLineages(int i, int j, RandomEngine& gen) const
+{
+    int level = 0;
+    int last = levels() - 1;
+    double weight = 1;
+
+    /* Deux bits par génération : le parent de chaque lignée. */
+    std::uint64_t bits = 0;
+    int available = 0;
+
+    while(i != j)
+    {
+        /* Les parents de la plus ancienne génération gardée sont inconnus. */
+        if(level == last)
+        {
+            return weight*horizon(i, j);
+        }
+
+        if(available == 0)
+        {
+            bits = gen();
+            available = 32;
+        }
+
+        std::size_t first = slot(level);
+
+        i = (bits & 1) ? mothers[first + i] : fathers[first + i];
+        j = (bits & 2) ? mothers[first + j] : fathers[first + j];
+
+        bits >>= 2;
+        available --;
+
+        weight *= scale;
+        level ++;
+    }
+
+    return weight*identity(level, i);
+}
+
+double Pedigree::kinship(int i, int j, RandomEngine& gen, int samples, double error) const
+{
+    int k = 0;
+    double sum = 0, sumSquares = 0;
+
+    if(i == j)
+    {
+        return identity(0, i);
+    }
+
+    for(k=1; k<=samples; k++)
+    {
+        double value = sampleLineages(i, j, gen);
+
+        sum += value;
+        sumSquares += value*value;
+
+        /* L'erreur type de la moyenne, contrôlée à chaque paquet. */
+        if(error > 0 && k%batch == 0)
+        {
+            double mean = sum/k;
+            double prior = (sum + 1)/(k + 2);
+            double variance = std::max(sumSquares/k - mean*mean, 0.0);
+
+            /* Un paquet sans aucune coalescence a une variance nulle : on ne s'arrête pas pour autant.
+            Les valeurs sont dans [0, 1], leur variance est donc bornée comme celle d'une loi de Bernoulli,
+            estimée avec un succès et un échec a priori. */
+            variance = std::max(variance, prior*(1 - prior));
+
+            if(variance <= error*error*(k - 1))
+            {
+                break;
+            }
+        }
+    }
+
+    return sum/std::min(k, samples);
+}
+
+double Pedigree::memory(int depth, int n)
+{
+    return double(depth)*n*(2*sizeof(int) + sizeof(double));
+}
+
+void Pedigree::save(CheckpointWriter& out) const
+{
+    out.put<std::int32_t>(newest);
+    out.put<std::int32_t>(generations);
+    out.putVector(mothers);
+    out.putVector(fathers);
+    out.putVector(inbreeding);
+    out.putVector(background);
+}
+
+void Pedigree::load(CheckpointReader& in)
+{
+    std::int32_t fileNewest = 0, fileGenerations = 0;
+
+    in.get(fileNewest);
+    in.get(fileGenerations);
+    in.getVector(mothers);
+    in.getVector(fathers);
+    in.getVector(inbreeding);
+    in.getVector(background);
+
+    newest = fileNewest;
+    generations = fileGenerations;
+}
@@ -0,0 +1,205 @@
+#ifndef PEDIGREE_H_INCLUDED
+#define PEDIGREE_H_INCLUDED
+
+#include <vector>
+
+#include "rng.h"
+#include "checkpoint.h"
+#include "relatedness.h"
+
+/**
+ * @file
+ */
+
+/**
+ * @brief
+ * Généalogie des dernières générations, pour estimer les apparentements sans matrice (kinship=pedigree).
+ *
+ * Chaque génération gardée stocke, pour chaque individu (dans l'ordre des lignes de la matrice d'apparentement),
+ * la ligne de sa mère et de son père dans la génération précédente et son taux de consanguinité f.
+ * La mémoire croît en profondeur·Ktot au lieu de Ktot².
+ *
+ * L'apparentement de deux individus est la probabilité que deux gènes tirés chacun chez l'un d'eux soient identiques.
+ * Il est estimé en remontant deux lignées de gènes : à chaque génération, chaque lignée passe à la mère
+ * ou au père (une chance sur deux) et l'apparentement est multiplié par 1 - mitigateRelatedness,
+ * comme dans la matrice. Si les lignées se rejoignent chez un individu, elles valent l'apparentement de
+ * cet individu avec lui-même, (1 - mitigateRelatedness)·(1 + f)/2 (1/2 pour les fondateurs) ;
+ * si elles sont encore séparées dans la plus ancienne génération gardée, elles valent la valeur de fond :
+ * 0 (background=zero), ou l'apparentement moyen de deux individus du patch où elles se trouvent
+ * à cette génération, ou de deux individus de patchs différents (background=mean),
+ * estimés à l'ajout de chaque génération.
+ * Sans valeur de fond, le biais n'est négligeable que si (1 - mitigateRelatedness)^profondeur l'est.
+ */
+
+class Pedigree
+{
+public:
+
+    Pedigree(void);
+
+    /**
+     * @brief
+     * Méthode qui réserve la généalogie. Elle ne contient alors que les fondateurs (non apparentés, f = 0).
+     *
+     * @param depth         Le nombre de générations gardées
+     * @param firstOfPatch  La position absolue du premier individu de chaque patch, plus Ktot à la fin
+     * @param mitigate      La diminution de l'apparentement à chaque génération
+     * @param background    La valeur des lignées encore séparées au-delà de la généalogie
+     */
+    void allocate(int depth, const std::vector<int>& firstOfPatch, double mitigate, backgroundBand background);
+
+    /**
+     * @brief
+     * Méthode qui ajoute une génération ; la plus ancienne est oubliée si la profondeur est atteinte.
+     * Les taux de consanguinité sont ensuite donnés par setInbreeding.
+     *
+     * @param mothers   La ligne de la mère de chaque individu dans la génération précédente
+     * @param fathers   La ligne du père de chaque individu dans la génération précédente
+     */
+    void push(const std::vector<int>& mothers, const std::vector<int>& fathers);
+
+    /**
+     * @brief
+     * Méthode qui donne le taux de consanguinité d'un individu de la dernière génération.
+     *
+     * @param i     La ligne de l'individu
+     * @param f     Son taux de consanguinité
+     */
+    void setInbreeding(int i, double f)
+    {
+        inbreeding[slot(0) + i] = f;
+    }
+
+    /**
+     * @brief
+     * Méthode qui estime l'apparentement moyen de deux individus de chaque patch de la dernière génération,
+     * et de deux individus de patchs différents (une paire de lignées par paire d'individus tirée), pour la valeur de fond.
+     * Elle est appelée une fois les taux de consanguinité donnés ; elle ne fait rien avec background=zero.
+     *
+     * @param gen       Le générateur aléatoire
+     * @param samples   Le nombre de paires tirées pour chaque moyenne
+     */
+    void updateBackground(RandomEngine& gen, int samples);
+
+    /**
+     * @brief
+     * Méthode qui estime l'apparentement de deux individus de la dernière génération.
+     *
+     * Les lignées sont tirées par paquets jusqu'à ce que l'erreur type de la moyenne
+     * descende sous la cible, ou jusqu'au nombre maximal de tirages. La variance utilisée
+     * n'est jamais inférieure à celle d'une loi de Bernoulli de même moyenne (avec un succès
+     * et un échec a priori) : des paquets sans coalescence ne suffisent pas à s'arrêter sur 0.
+     * L'arrêt dépend quand même des tirages : si les lignées se rejoignent rarement (une fois
+     * sur 10 à 100 tirages), l'estimation est en moyenne de 5 à 10 % trop basse avec error=0.02.
+     * Avec error = 0, le nombre de tirages est fixe et l'estimation sans biais.
+     *
+     * @param i         La ligne du premier individu
+     * @param j         La ligne du second individu
+     * @param gen       Le générateur aléatoire
+     * @param samples   Le nombre maximal de paires de lignées tirées
+     * @param error     L'erreur type visée (0 : toujours samples tirages)
+     *
+     * @return          L'apparentement estimé
+     */
+    double kinship(int i, int j, RandomEngine& gen, int samples, double error) const;
+
+    /**
+     * @brief
+     * Méthode qui calcule la mémoire occupée par une généalogie.
+     *
+     * @param depth     Le nombre de générations gardées
+     * @param n         Le nombre d'individus d'une génération
+     *
+     * @return          La mémoire, en octets
+     */
+    static double memory(int depth, int n);
+
+    /**
+     * @brief
+     * Méthode qui écrit la généalogie dans un instantané.
+     *
+     * @param out   L'instantané
+     */
+    void save(CheckpointWriter& out) const;
+
+    /**
+     * @brief
+     * Méthode qui relit la généalogie d'un instantané (elle doit avoir été réservée avec les mêmes dimensions).
+     *
+     * @param in    L'instantané
+     */
+    void load(CheckpointReader& in);
+
+private:
+
+    int depth; /**< @brief Le nombre de générations gardées */
+    int n; /**< @brief Le nombre d'individus d'une génération */
+    double scale; /**< @brief 1 - mitigateRelatedness */
+    backgroundBand backgroundType; /**< @brief La valeur des lignées encore séparées au-delà de la généalogie */
+    std::vector<int> firstOfPatch; /**< @brief La position absolue du premier individu de chaque patch, plus Ktot */
+
+    int newest; /**< @brief La place de la dernière génération dans l'anneau */
+    int generations; /**< @brief Le nombre de générations ajoutées depuis les fondateurs */
+
+    std::vector<int> mothers; /**< @brief Les mères, génération par génération (anneau de depth générations) */
+    std::vector<int> fathers; /**< @brief Les pères, génération par génération */
+    std::vector<double> inbreeding; /**< @brief Les taux de consanguinité, génération par génération */
+    std::vector<double> background; /**< @brief L'apparentement moyen dans chaque patch puis entre patchs, génération par génération */
+
+    /** @brief Le nombre de paires de lignées tirées entre deux contrôles de l'erreur */
+    static const int batch = 16;
+
+    /**
+     * @brief
+     * Renvoie la position du premier individu d'une génération dans l'anneau.
+     *
+     * @param level     L'ancienneté de la génération (0 pour la dernière)
+     */
+    std::size_t slot(int level) const
+    {
+        return std::size_t((newest - level + depth)%depth)*n;
+    }
+
+    /** @brief Le nombre de générations gardées, fondateurs compris tant qu'ils le sont */
+    int levels(void) const;
+
+    /**
+     * @brief
+     * Méthode qui remonte une paire de lignées de gènes.
+     *
+     * @param i     La ligne du premier individu dans la dernière génération
+     * @param j     La ligne du second individu
+     * @param gen   Le générateur aléatoire
+     *
+     * @return      L'apparentement porté par cette paire de lignées
+     */
+    double sampleLineages(int i, int j, RandomEngine& gen) const;
+
+    /**
+     * @brief
+     * Renvoie le patch d'un individu.
+     *
+     * @param i     Sa ligne
+     */
+    int patchOf(int i) const;
+
+    /**
+     * @brief
+     * Renvoie la valeur de fond de deux individus distincts de la plus ancienne génération gardée.
+     *
+     * @param i     La ligne du premier individu
+     * @param j     La ligne du second individu
+     */
+    double horizon(int i, int j) const;
+
+    /**
+     * @brief
+     * Renvoie l'apparentement d'un individu avec lui-même.
+     *
+     * @param level     L'ancienneté de sa génération
+     * @param i         Sa ligne
+     */
+    double identity(int level, int i) const;
+};
+
+#endif // PEDIGREE_H_INCLUDED
@@ -0,0 +1,66 @@
+#include <vector>
+
+#include "population.h"
+#include "individual.h"
+
+Population::Population(void)
+{
+}
+
+int Population::size(void) const
+{
+    return int(s.size());
+}
+
+bool Population::empty(void) const
+{
+    return s.empty();
+}
+
+void Population::reserve(int n)
+{
+    s.reserve(n);
+    d.reserve(n);
+    f.reserve(n);
+}
+
+void Population::emplace_back(double s, double d, double f)
+{
+    this->s.push_back(s);
+    this->d.push_back(d);
+    this->f.push_back(f);
+}
+
+void Population::push_back(const Individual& ind)
+{
+    emplace_back(ind.s, ind.d, ind.f);
+}
+
+Individual Population::operator[](int i) const
+{
+    return Individual(s[i], d[i], f[i]);
+}
+
+void Population::set(int i, const Individual& ind)
+{
+    s[i] = ind.s;
+    d[i] = ind.d;
+    f[i] = ind.f;
+}
+
+void Population::truncate(int n)
+{
+    if(n < size())
+    {
+        s.resize(n);
+        d.resize(n);
+        f.resize(n);
+    }
+}
+
+void Population::clear(void)
+{
+    s.clear();
+    d.clear();
+    f.clear();
+}
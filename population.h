@@ -0,0 +1,97 @@
+#ifndef POPULATION_H_INCLUDED
+#define POPULATION_H_INCLUDED
+
+#include <vector>
+
+#include "individual.h"
+
+/**
+ * @file
+ */
+
+/**
+ * @brief
+ * Contient les individus d'un patch sous forme de tableaux séparés
+ * (un tableau contigu par trait).
+ *
+ * Les boucles de calcul (pressions, moyennes, rapports) ne lisent qu'un ou
+ * deux traits à la fois : stocker s, d et f séparément permet de parcourir
+ * la mémoire de manière continue et laisse le compilateur vectoriser.
+ * L'accès individu par individu reste possible via operator[] et set().
+ */
+
+class Population
+{
+public:
+
+    Population(void);
+
+    std::vector<double> s; /**< @brief Les taux d'autofécondation */
+    std::vector<double> d; /**< @brief Les taux de dispersion */
+    std::vector<double> f; /**< @brief Les taux de consanguinité */
+
+    /** @brief Le nombre d'individus de la population */
+    int size(void) const;
+
+    /** @brief Vrai si la population ne contient aucun individu */
+    bool empty(void) const;
+
+    /**
+     * @brief
+     * Méthode qui réserve la mémoire pour n individus.
+     *
+     * @param n     Le nombre d'individus à prévoir
+     */
+    void reserve(int n);
+
+    /**
+     * @brief
+     * Méthode qui ajoute un individu à la fin de la population.
+     *
+     * @param s     Le taux d'autofécondation
+     * @param d     Le taux de dispersion
+     * @param f     Le taux de consanguinité
+     */
+    void emplace_back(double s, double d, double f);
+
+    /**
+     * @brief
+     * Méthode qui ajoute un individu à la fin de la population.
+     *
+     * @param ind   L'individu à ajouter
+     */
+    void push_back(const Individual& ind);
+
+    /**
+     * @brief
+     * Renvoie une copie de l'individu à la position i.
+     *
+     * @param i     La position de l'individu dans la population
+     *
+     * @return      L'individu
+     */
+    Individual operator[](int i) const;
+
+    /**
+     * @brief
+     * Méthode qui remplace l'individu à la position i.
+     *
+     * @param i     La position de l'individu dans la population
+     * @param ind   Le nouvel individu
+     */
+    void set(int i, const Individual& ind);
+
+    /**
+     * @brief
+     * Méthode qui tue les individus au-delà des n premiers.
+     * La mémoire n'est pas libérée.
+     *
+     * @param n     Le nombre d'individus à conserver
+     */
+    void truncate(int n);
+
+    /** @brief Méthode qui vide la population sans libérer la mémoire. */
+    void clear(void);
+};
+
+#endif // POPULATION_H_INCLUDED
@@ -0,0 +1,182 @@
+#include "profile.h"
+
+#ifdef PLANTS_PROFILE
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace
+{
+    /** @brief Le nom de chaque étape dans les fichiers */
+    const char* phaseNames[NPhases] = {"pollinisation", "shift", "generation", "pressions", "descendants", "tirage",
+                                       "mutation", "convergence", "apparentement", "rapport", "logPoll", "instantane"};
+
+    /** @brief Les étapes mesurées dans chaque thread, dont le temps est une somme sur les threads */
+    bool isParallel(int phase)
+    {
+        return phase == pressurePhase || phase == offspringPhase || phase == samplingPhase || phase == mutationPhase;
+    }
+
+    std::uint64_t steadyNanoseconds(void)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+Profiler::Profiler(void)
+{
+    idWorld = 0;
+    seriesFrequency = 0;
+    startTicks = 0;
+    startTime = 0;
+    overhead = 0;
+}
+
+void Profiler::open(int idWorld, int nWorkers, int seriesFrequency)
+{
+    int i = 0;
+
+    this->idWorld = idWorld;
+    this->seriesFrequency = seriesFrequency;
+
+    slots.assign(nWorkers, Slot());
+    lastTicks.assign(NPhases, 0);
+
+    /* Le coût d'une mesure vide : le plus petit écart entre deux lectures du compteur. */
+    overhead = ~std::uint64_t(0);
+    for(i=0; i<1000; i++)
+    {
+        std::uint64_t start = now();
+        overhead = std::min(overhead, now() - start);
+    }
+
+    if(seriesFrequency > 0)
+    {
+        series.open("profile_series_" + std::to_string(idWorld) + ".txt");
+
+        series << "Gen";
+        for(i=0; i<NPhases; i++)
+        {
+            series << '\t' << phaseNames[i];
+        }
+        series << '\n';
+    }
+
+    startTicks = now();
+    startTime = steadyNanoseconds();
+}
+
+std::uint64_t Profiler::now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return steadyNanoseconds();
+#endif
+}
+
+double Profiler::ticksPerSecond(void) const
+{
+    double seconds = (steadyNanoseconds() - startTime)*1e-9;
+
+    if(seconds <= 0)
+    {
+        return 1e9;
+    }
+
+    return (now() - startTicks)/seconds;
+}
+
+std::uint64_t Profiler::total(phaseProfile phase, bool calls) const
+{
+    std::uint64_t sum = 0;
+
+    for(const Slot& slot : slots)
+    {
+        sum += calls ? slot.calls[phase] : slot.ticks[phase];
+    }
+
+    return sum;
+}
+
+void Profiler::endGeneration(int genCount)
+{
+    int i = 0;
+
+    if(seriesFrequency <= 0 || genCount%seriesFrequency != 0)
+    {
+        return;
+    }
+
+    double msPerTick = 1e3/ticksPerSecond();
+    std::vector<double> ticks(NPhases);
+
+    /* Chaque ligne donne le temps (ms) passé dans chaque étape depuis la ligne précédente. */
+    for(i=0; i<NPhases; i++)
+    {
+        std::uint64_t current = total(phaseProfile(i), false);
+
+        ticks[i] = current - lastTicks[i];
+        lastTicks[i] = current;
+    }
+
+    series << genCount;
+    for(i=0; i<NPhases; i++)
+    {
+        series << '\t' << std::fixed << std::setprecision(3) << ticks[i]*msPerTick;
+    }
+    series << '\n';
+}
+
+void Profiler::write(int generations)
+{
+    int i = 0;
+
+    double perSecond = ticksPerSecond();
+    double wall = (now() - startTicks)/perSecond;
+    double measured = 0;
+
+    std::vector<double> ticks(NPhases);
+    for(i=0; i<NPhases; i++)
+    {
+        ticks[i] = total(phaseProfile(i), false);
+    }
+
+    std::ofstream profile("profile_" + std::to_string(idWorld) + ".txt");
+
+    profile << "Monde " << idWorld << " : " << generations << " générations en " << wall << " s, "
+            << slots.size() << " thread(s)" << '\n';
+    profile << "Les étapes pressions, descendants, tirage et mutation sont sommées sur tous les threads (temps CPU) ;"
+            << " elles sont comprises dans generation, et tirage et mutation dans descendants." << '\n';
+    profile << "Etape" << '\t' << "Appels" << '\t' << "Temps (s)" << '\t' << "Part (%)" << '\t' << "ns/appel" << '\n';
+
+    for(i=0; i<NPhases; i++)
+    {
+        std::uint64_t calls = total(phaseProfile(i), true);
+        double seconds = ticks[i]/perSecond;
+
+        if(!isParallel(i))
+        {
+            measured += seconds;
+        }
+
+        profile << phaseNames[i] << '\t' << calls << '\t' << seconds << '\t'
+                << 100*seconds/wall << '\t' << (calls ? seconds*1e9/calls : 0) << '\n';
+    }
+
+    /* Le reste de la boucle : progression, échanges des matrices... */
+    profile << "autre" << '\t' << '\t' << wall - measured << '\t' << 100*(wall - measured)/wall << '\t' << '\n';
+
+    series.close();
+}
+
+#endif // PLANTS_PROFILE
@@ -0,0 +1,181 @@
+#ifndef PROFILE_H_INCLUDED
+#define PROFILE_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+
+/**
+ * @file
+ *
+ * Mesure du temps passé dans chaque étape d'une génération.
+ *
+ * Compiler avec -DPLANTS_PROFILE pour l'activer : chaque monde écrit alors profile_<id>.txt
+ * (temps et nombre d'appels de chaque étape) à la fin de sa simulation et, avec profile=N,
+ * la série profile_series_<id>.txt (temps de chaque étape toutes les N générations).
+ * Sans ce drapeau, les mesures disparaissent à la compilation.
+ *
+ * Le temps est lu sur le compteur du processeur (TSC) quand il existe,
+ * converti en secondes à la fin grâce à steady_clock, sinon directement sur steady_clock.
+ */
+
+/** @brief Énumération des étapes mesurées. */
+typedef enum _phase_
+{
+    pollinationPhase = 0,   /**< Tirage de l'état de pollinisation des patchs */
+    shiftPhase = 1,         /**< Déplacement de l'aire de répartition (rotation des populations) */
+    generationPhase = 2,    /**< Création de toute la nouvelle génération (temps écoulé) */
+    pressurePhase = 3,      /**< Calcul et rassemblement des pressions, table des alias (somme sur les threads) */
+    offspringPhase = 4,     /**< Création des descendants : tirage des parents et mutations (somme sur les threads) */
+    samplingPhase = 5,      /**< Part de offspringPhase passée à tirer les parents et créer les descendants */
+    mutationPhase = 6,      /**< Part de offspringPhase passée dans les mutations, appliquées en lot */
+    convergencePhase = 7,   /**< Vérification de la convergence */
+    relatednessPhase = 8,   /**< Calcul des nouveaux apparentements */
+    reportPhase = 9,        /**< Écriture du rapport et de la matrice d'apparentement finale */
+    logPollPhase = 10,      /**< Écriture du journal de pollinisation */
+    checkpointPhase = 11,   /**< Écriture des instantanés */
+    NPhases = 12,
+} phaseProfile;
+
+#ifdef PLANTS_PROFILE
+
+/**
+ * @brief
+ * Accumule le temps et le nombre d'appels de chaque étape, thread par thread.
+ */
+
+class Profiler
+{
+public:
+
+    Profiler(void);
+
+    /**
+     * @brief
+     * Méthode qui remet les compteurs à zéro et ouvre la série si elle est demandée.
+     *
+     * @param idWorld           L'identifiant du monde, qui nomme les fichiers
+     * @param nWorkers          Le nombre de threads qui créent les générations
+     * @param seriesFrequency   Le nombre de générations entre deux lignes de la série (0 = pas de série)
+     */
+    void open(int idWorld, int nWorkers, int seriesFrequency);
+
+    /** @brief Le compteur de temps (cycles du TSC, ou nanosecondes) */
+    static std::uint64_t now(void);
+
+    /**
+     * @brief
+     * Méthode qui ajoute une durée à une étape.
+     *
+     * @param worker    Le numéro du thread
+     * @param phase     L'étape
+     * @param ticks     La durée, dans l'unité de now()
+     * @param calls     Le nombre d'appels que représente cette durée
+     */
+    void add(int worker, phaseProfile phase, std::uint64_t ticks, int calls)
+    {
+        /* On retire le coût de la lecture du compteur. */
+        ticks = ticks > overhead*calls ? ticks - overhead*calls : 0;
+
+        slots[worker].ticks[phase] += ticks;
+        slots[worker].calls[phase] += calls;
+    }
+
+    /**
+     * @brief
+     * Méthode appelée à la fin de chaque génération, qui écrit une ligne de la série si besoin.
+     *
+     * @param genCount  La génération qui vient de se terminer
+     */
+    void endGeneration(int genCount);
+
+    /**
+     * @brief
+     * Méthode qui écrit le résumé profile_<id>.txt.
+     *
+     * @param generations   Le nombre de générations simulées par ce processus
+     */
+    void write(int generations);
+
+private:
+
+    /** @brief Les compteurs d'un thread, sur leur propre ligne de cache */
+    struct alignas(64) Slot
+    {
+        std::uint64_t ticks[NPhases];
+        std::uint64_t calls[NPhases];
+    };
+
+    std::vector<Slot> slots; /**< @brief Les compteurs de chaque thread */
+    std::vector<std::uint64_t> lastTicks; /**< @brief Le total de chaque étape à la dernière ligne de la série */
+
+    int idWorld; /**< @brief L'identifiant du monde */
+    int seriesFrequency; /**< @brief Le nombre de générations entre deux lignes de la série */
+    std::ofstream series; /**< @brief La série profile_series_<id>.txt */
+
+    std::uint64_t startTicks; /**< @brief Le compteur au début de la mesure */
+    std::uint64_t startTime; /**< @brief steady_clock (ns) au début de la mesure */
+    std::uint64_t overhead; /**< @brief Le coût d'une mesure vide, retiré de chaque mesure */
+
+    /** @brief Le nombre de ticks par seconde, estimé depuis le début de la mesure */
+    double ticksPerSecond(void) const;
+
+    /** @brief Le total d'une étape, sur tous les threads */
+    std::uint64_t total(phaseProfile phase, bool calls) const;
+};
+
+/**
+ * @brief
+ * Mesure une étape du début à la fin du bloc qui la contient.
+ */
+
+class ProfileScope
+{
+public:
+
+    ProfileScope(Profiler& profiler, int worker, phaseProfile phase) : profiler(profiler)
+    {
+        this->worker = worker;
+        this->phase = phase;
+        start = Profiler::now();
+    }
+
+    ~ProfileScope()
+    {
+        profiler.add(worker, phase, Profiler::now() - start, 1);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+
+    Profiler& profiler;
+    int worker;
+    phaseProfile phase;
+    std::uint64_t start;
+};
+
+/** @brief Mesure l'étape phase jusqu'à la fin du bloc (un seul par bloc). */
+#define PROFILE_PHASE(profiler, worker, phase) ProfileScope profileScope((profiler), (worker), (phase))
+
+#else
+
+/** @brief Version vide, quand les mesures ne sont pas compilées. */
+class Profiler
+{
+public:
+
+    void open(int /*idWorld*/, int /*nWorkers*/, int /*seriesFrequency*/) {}
+
+    void endGeneration(int /*genCount*/) {}
+
+    void write(int /*generations*/) {}
+};
+
+#define PROFILE_PHASE(profiler, worker, phase)
+
+#endif // PLANTS_PROFILE
+
+#endif // PROFILE_H_INCLUDED
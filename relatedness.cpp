@@ -0,0 +1,305 @@
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "relatedness.h"
+
+RelatednessMatrix::RelatednessMatrix(void)
+{
+    values = nullptr;
+    n = 0;
+    nValues = 0;
+    bytes = 0;
+}
+
+RelatednessMatrix::~RelatednessMatrix()
+{
+    release();
+}
+
+namespace
+{
+#ifdef __AVX2__
+    /* Additionne quatre séries de quatre apparentements lus aux positions données,
+    dans le même ordre que la boucle simple, puis applique le facteur. */
+    inline void storeSum(const relatedness_t* values, __m256i mm, __m256i ff, __m256i fm, __m256i mf,
+                         __m256d scale, relatedness_t* out)
+    {
+        const __m256d quarter = _mm256_set1_pd(0.25);
+
+#ifdef PLANTS_RELATEDNESS_FLOAT
+        __m128 sum = _mm256_i64gather_ps(values, mm, 4);
+        sum = _mm_add_ps(sum, _mm256_i64gather_ps(values, ff, 4));
+        sum = _mm_add_ps(sum, _mm256_i64gather_ps(values, fm, 4));
+        sum = _mm_add_ps(sum, _mm256_i64gather_ps(values, mf, 4));
+
+        _mm_storeu_ps(out, _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_mul_pd(scale, _mm256_cvtps_pd(sum)), quarter)));
+#else
+        __m256d sum = _mm256_i64gather_pd(values, mm, 8);
+        sum = _mm256_add_pd(sum, _mm256_i64gather_pd(values, ff, 8));
+        sum = _mm256_add_pd(sum, _mm256_i64gather_pd(values, fm, 8));
+        sum = _mm256_add_pd(sum, _mm256_i64gather_pd(values, mf, 8));
+
+        _mm256_storeu_pd(out, _mm256_mul_pd(_mm256_mul_pd(scale, sum), quarter));
+#endif
+    }
+#endif
+
+    /* Une projection anonyme est remplie de zéros par le système,
+    et les pages ne sont réellement occupées qu'à la première écriture. */
+    void* mapZeros(std::size_t bytes, bool hugePages)
+    {
+        void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if(block == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+
+#ifdef MADV_HUGEPAGE
+        /* Des pages de 2 Mo réduisent les défauts de TLB sur les grandes matrices. */
+        if(hugePages)
+        {
+            madvise(block, bytes, MADV_HUGEPAGE);
+        }
+#endif
+
+        return block;
+    }
+}
+
+void RelatednessMatrix::allocate(int n, bool hugePages)
+{
+    release();
+
+    this->n = n;
+    nValues = rowOffset(n);
+    bytes = nValues*sizeof(relatedness_t);
+
+    if(bytes == 0)
+    {
+        return;
+    }
+
+    values = static_cast<relatedness_t*>(mapZeros(bytes, hugePages));
+}
+
+void RelatednessMatrix::swap(RelatednessMatrix& other)
+{
+    std::swap(values, other.values);
+    std::swap(n, other.n);
+    std::swap(nValues, other.nValues);
+    std::swap(bytes, other.bytes);
+}
+
+#ifdef __AVX2__
+namespace
+{
+    /* Les positions de quatre paires dans la demi-matrice : hi*(hi + 1)/2 + lo. */
+    inline __m256i densePosition(__m128i a, __m128i b)
+    {
+        const __m256i hi = _mm256_cvtepi32_epi64(_mm_max_epi32(a, b));
+        const __m256i lo = _mm256_cvtepi32_epi64(_mm_min_epi32(a, b));
+        const __m256i product = _mm256_mul_epu32(hi, _mm256_add_epi64(hi, _mm256_set1_epi64x(1)));
+
+        return _mm256_add_epi64(_mm256_srli_epi64(product, 1), lo);
+    }
+}
+#endif
+
+void RelatednessMatrix::sumParents(int mother, int father, const int* mothers, const int* fathers, int n,
+                                   double scale, relatedness_t* out) const
+{
+    int k = 0;
+
+#ifdef __AVX2__
+    const __m128i vMother = _mm_set1_epi32(mother);
+    const __m128i vFather = _mm_set1_epi32(father);
+    const __m256d vScale = _mm256_set1_pd(scale);
+
+    for(k=0; k+4<=n; k+=4)
+    {
+        const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mothers + k));
+        const __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fathers + k));
+
+        storeSum(values, densePosition(vMother, m), densePosition(vFather, f),
+                 densePosition(vFather, m), densePosition(vMother, f), vScale, out + k);
+    }
+#endif
+
+    for(; k<n; k++)
+    {
+        out[k] = scale*(values[position(mother, mothers[k])] + values[position(father, fathers[k])] +
+                        values[position(father, mothers[k])] + values[position(mother, fathers[k])])*0.25;
+    }
+}
+
+double RelatednessMatrix::memory(int n)
+{
+    return double(rowOffset(n))*sizeof(relatedness_t);
+}
+
+void RelatednessMatrix::release(void)
+{
+    if(values != nullptr)
+    {
+        munmap(values, bytes);
+    }
+
+    values = nullptr;
+    n = 0;
+    nValues = 0;
+    bytes = 0;
+}
+
+BandedRelatednessMatrix::BandedRelatednessMatrix(void)
+{
+    values = nullptr;
+    n = 0;
+    band = 0;
+    nValues = 0;
+    bytes = 0;
+}
+
+BandedRelatednessMatrix::~BandedRelatednessMatrix()
+{
+    release();
+}
+
+void BandedRelatednessMatrix::allocate(const std::vector<int>& firstOfPatch, int band, bool hugePages)
+{
+    int i = 0, p = 0;
+    int NPatch = int(firstOfPatch.size()) - 1;
+
+    release();
+
+    this->band = band;
+    n = firstOfPatch.back();
+
+    start.resize(n);
+    first.resize(n);
+
+    /* Chaque ligne commence au premier individu du patch situé à «band» patchs à gauche. */
+    for(p=0; p<NPatch; p++)
+    {
+        for(i=firstOfPatch[p]; i<firstOfPatch[p + 1]; i++)
+        {
+            start[i] = nValues;
+            first[i] = firstOfPatch[std::max(0, p - band)];
+            nValues += i - first[i] + 1;
+        }
+    }
+
+    /* Une case de plus pour la valeur de fond. */
+    bytes = (nValues + 1)*sizeof(relatedness_t);
+    values = static_cast<relatedness_t*>(mapZeros(bytes, hugePages));
+}
+
+void BandedRelatednessMatrix::swap(BandedRelatednessMatrix& other)
+{
+    std::swap(values, other.values);
+    std::swap(n, other.n);
+    std::swap(band, other.band);
+    std::swap(nValues, other.nValues);
+    std::swap(bytes, other.bytes);
+    start.swap(other.start);
+    first.swap(other.first);
+}
+
+#ifdef __AVX2__
+namespace
+{
+    /* Les positions de quatre paires dans la matrice en bande,
+    ou la case de la valeur de fond pour les paires hors de la bande. */
+    inline __m256i bandedPosition(__m128i a, __m128i b, const std::size_t* start, const int* first, std::size_t background)
+    {
+        const __m128i hi = _mm_max_epi32(a, b);
+        const __m128i lo = _mm_min_epi32(a, b);
+
+        const __m256i rowStart = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(start), hi, 8);
+        const __m128i rowFirst = _mm_i32gather_epi32(first, hi, 4);
+
+        const __m256i inRow = _mm256_add_epi64(rowStart, _mm256_cvtepi32_epi64(_mm_sub_epi32(lo, rowFirst)));
+        const __m256i outside = _mm256_cvtepi32_epi64(_mm_cmplt_epi32(lo, rowFirst));
+
+        return _mm256_blendv_epi8(inRow, _mm256_set1_epi64x(background), outside);
+    }
+}
+#endif
+
+void BandedRelatednessMatrix::sumParents(int mother, int father, const int* mothers, const int* fathers, int n,
+                                         double scale, relatedness_t* out) const
+{
+    int k = 0;
+
+#ifdef __AVX2__
+    const __m128i vMother = _mm_set1_epi32(mother);
+    const __m128i vFather = _mm_set1_epi32(father);
+    const __m256d vScale = _mm256_set1_pd(scale);
+
+    for(k=0; k+4<=n; k+=4)
+    {
+        const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mothers + k));
+        const __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fathers + k));
+
+        storeSum(values, bandedPosition(vMother, m, start.data(), first.data(), nValues),
+                 bandedPosition(vFather, f, start.data(), first.data(), nValues),
+                 bandedPosition(vFather, m, start.data(), first.data(), nValues),
+                 bandedPosition(vMother, f, start.data(), first.data(), nValues), vScale, out + k);
+    }
+#endif
+
+    for(; k<n; k++)
+    {
+        out[k] = scale*(values[position(mother, mothers[k])] + values[position(father, fathers[k])] +
+                        values[position(father, mothers[k])] + values[position(mother, fathers[k])])*0.25;
+    }
+}
+
+double BandedRelatednessMatrix::memory(const std::vector<int>& K, int band)
+{
+    int p = 0, q = 0;
+    double count = 0;
+
+    for(p=0; p<int(K.size()); p++)
+    {
+        /* Les blocs des patchs à gauche dans la bande, puis le triangle du patch. */
+        for(q=std::max(0, p - band); q<p; q++)
+        {
+            count += double(K[p])*K[q];
+        }
+
+        count += 0.5*K[p]*(K[p] + 1.0);
+    }
+
+    /* Plus les positions et premières colonnes de chaque ligne. */
+    double Ktot = 0;
+    for(int k : K)
+    {
+        Ktot += k;
+    }
+
+    return count*sizeof(relatedness_t) + Ktot*(sizeof(std::size_t) + sizeof(int));
+}
+
+void BandedRelatednessMatrix::release(void)
+{
+    if(values != nullptr)
+    {
+        munmap(values, bytes);
+    }
+
+    values = nullptr;
+    n = 0;
+    nValues = 0;
+    bytes = 0;
+    start.clear();
+    first.clear();
+}
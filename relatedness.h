@@ -0,0 +1,403 @@
+#ifndef RELATEDNESS_H_INCLUDED
+#define RELATEDNESS_H_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @file
+ */
+
+/**
+ * @brief
+ * Le type des apparentements stockés.
+ *
+ * Compiler avec -DPLANTS_RELATEDNESS_FLOAT pour les stocker en float :
+ * la mémoire est divisée par deux, au prix de la précision.
+ */
+#ifdef PLANTS_RELATEDNESS_FLOAT
+typedef float relatedness_t;
+#else
+typedef double relatedness_t;
+#endif
+
+/** @brief Énumération qui permet de choisir l'apparentement des paires hors de la bande. */
+typedef enum _bandBackground_
+{
+    zeroBackground = 0,     /**< Les paires éloignées ne sont pas apparentées. */
+    meanBackground = 1,     /**< L'apparentement moyen des paires juste au-delà de la bande, recalculé à chaque génération. */
+} backgroundBand;
+
+/**
+ * @brief
+ * Demi-matrice (triangle inférieur, diagonale comprise) des apparentements
+ * entre tous les individus, rangée ligne par ligne dans un seul bloc de mémoire.
+ *
+ * La ligne i commence à la position i*(i+1)/2, il n'y a donc
+ * aucun pointeur à suivre pour trouver un apparentement.
+ */
+
+class RelatednessMatrix
+{
+public:
+
+    RelatednessMatrix(void);
+
+    ~RelatednessMatrix();
+
+    RelatednessMatrix(const RelatednessMatrix&) = delete;
+    RelatednessMatrix& operator=(const RelatednessMatrix&) = delete;
+
+    /**
+     * @brief
+     * Méthode qui réserve la demi-matrice pour n individus, remplie de zéros.
+     *
+     * @param n             Le nombre d'individus
+     * @param hugePages     Si on demande au système des pages de grande taille
+     */
+    void allocate(int n, bool hugePages);
+
+    /** @brief Le nombre d'individus */
+    int size(void) const
+    {
+        return n;
+    }
+
+    /**
+     * @brief
+     * Renvoie la position de la ligne i dans le bloc de mémoire.
+     *
+     * @param i     Le numéro de la ligne
+     *
+     * @return      La position du premier élément de la ligne
+     */
+    static std::size_t rowOffset(int i)
+    {
+        return std::size_t(i)*(std::size_t(i) + 1)/2;
+    }
+
+    /**
+     * @brief
+     * Renvoie la position d'une paire dans le bloc de mémoire.
+     *
+     * @param i     La position absolue du premier individu
+     * @param j     La position absolue du second individu (j <= i)
+     */
+    std::size_t index(int i, int j) const
+    {
+        return rowOffset(i) + j;
+    }
+
+    /**
+     * @brief
+     * Renvoie la position d'une paire dans le bloc de mémoire, dans n'importe quel ordre.
+     *
+     * @param i     La position absolue du premier individu
+     * @param j     La position absolue du second individu
+     */
+    std::size_t position(int i, int j) const
+    {
+        return i >= j ? index(i, j) : index(j, i);
+    }
+
+    /**
+     * @brief
+     * Renvoie l'apparentement entre deux individus, dans n'importe quel ordre.
+     *
+     * @param i     La position absolue du premier individu
+     * @param j     La position absolue du second individu
+     *
+     * @return      L'apparentement
+     */
+    relatedness_t get(int i, int j) const
+    {
+        return values[position(i, j)];
+    }
+
+    /**
+     * @brief
+     * Renvoie la ligne i (les apparentements avec les individus 0 à i).
+     *
+     * @param i     La position absolue de l'individu
+     *
+     * @return      Le début de la ligne
+     */
+    relatedness_t* row(int i)
+    {
+        return values + rowOffset(i);
+    }
+
+    const relatedness_t* row(int i) const
+    {
+        return values + rowOffset(i);
+    }
+
+    /**
+     * @brief
+     * Renvoie la première colonne stockée de la ligne i (toujours 0 ici).
+     *
+     * @param i     Le numéro de la ligne
+     */
+    int firstColumn(int /*i*/) const
+    {
+        return 0;
+    }
+
+    /**
+     * @brief
+     * Méthode qui calcule une portion de ligne de la nouvelle matrice d'apparentement.
+     *
+     * Pour chaque k, out[k] = scale*(R(mother, mothers[k]) + R(father, fathers[k])
+     * + R(father, mothers[k]) + R(mother, fathers[k]))*0.25, où R est l'apparentement des parents.
+     * Compilé avec AVX2 (-mavx2 ou -march=native), les positions sont calculées et les apparentements
+     * lus (gather) quatre à la fois ; le résultat est identique à celui de la boucle simple.
+     *
+     * @param mother    La mère de l'individu de la ligne
+     * @param father    Le père de l'individu de la ligne
+     * @param mothers   Les mères des individus des colonnes
+     * @param fathers   Les pères des individus des colonnes
+     * @param n         Le nombre de colonnes à calculer
+     * @param scale     Le facteur 1 - mitigateRelatedness
+     * @param out       Le début de la portion de ligne
+     */
+    void sumParents(int mother, int father, const int* mothers, const int* fathers, int n, double scale, relatedness_t* out) const;
+
+    /** @brief Le début du bloc de mémoire */
+    relatedness_t* data(void)
+    {
+        return values;
+    }
+
+    const relatedness_t* data(void) const
+    {
+        return values;
+    }
+
+    /** @brief Le nombre d'éléments de la demi-matrice */
+    std::size_t count(void) const
+    {
+        return nValues;
+    }
+
+    /**
+     * @brief
+     * Méthode qui échange le contenu de deux matrices (seuls les pointeurs sont échangés).
+     *
+     * @param other     L'autre matrice
+     */
+    void swap(RelatednessMatrix& other);
+
+    /**
+     * @brief
+     * Méthode qui calcule la mémoire occupée par une demi-matrice.
+     *
+     * @param n     Le nombre d'individus
+     *
+     * @return      La mémoire, en octets
+     */
+    static double memory(int n);
+
+private:
+
+    relatedness_t* values; /**< @brief Le bloc de mémoire */
+    int n; /**< @brief Le nombre d'individus */
+    std::size_t nValues; /**< @brief Le nombre d'éléments */
+    std::size_t bytes; /**< @brief La taille du bloc de mémoire */
+
+    /** @brief Méthode qui rend la mémoire au système. */
+    void release(void);
+};
+
+/**
+ * @brief
+ * Apparentements limités aux paires d'individus proches dans l'espace.
+ *
+ * Seules les paires dont les patchs sont à une distance inférieure ou égale
+ * à la largeur de bande sont stockées (en blocs de patchs, ligne par ligne).
+ * Toutes les autres paires ont la même valeur de fond : zéro, ou une estimation
+ * de l'apparentement moyen des paires juste au-delà de la bande.
+ * La mémoire et le temps de calcul croissent alors en NPatch·K² au lieu de (NPatch·K)².
+ */
+
+class BandedRelatednessMatrix
+{
+public:
+
+    BandedRelatednessMatrix(void);
+
+    ~BandedRelatednessMatrix();
+
+    BandedRelatednessMatrix(const BandedRelatednessMatrix&) = delete;
+    BandedRelatednessMatrix& operator=(const BandedRelatednessMatrix&) = delete;
+
+    /**
+     * @brief
+     * Méthode qui réserve la matrice, remplie de zéros.
+     *
+     * @param firstOfPatch  La position absolue du premier individu de chaque patch, plus le nombre total d'individus à la fin
+     * @param band          La distance maximale (en patchs) des paires stockées
+     * @param hugePages     Si on demande au système des pages de grande taille
+     */
+    void allocate(const std::vector<int>& firstOfPatch, int band, bool hugePages);
+
+    /** @brief Le nombre d'individus */
+    int size(void) const
+    {
+        return n;
+    }
+
+    /** @brief La distance maximale (en patchs) des paires stockées */
+    int bandWidth(void) const
+    {
+        return band;
+    }
+
+    /**
+     * @brief
+     * Renvoie la position d'une paire dans le bloc de mémoire.
+     * Les paires hors de la bande renvoient la case de la valeur de fond.
+     *
+     * @param i     La position absolue du premier individu
+     * @param j     La position absolue du second individu (j <= i)
+     */
+    std::size_t index(int i, int j) const
+    {
+        return j >= first[i] ? start[i] + (j - first[i]) : nValues;
+    }
+
+    /**
+     * @brief
+     * Renvoie la position d'une paire dans le bloc de mémoire, dans n'importe quel ordre.
+     *
+     * @param i     La position absolue du premier individu
+     * @param j     La position absolue du second individu
+     */
+    std::size_t position(int i, int j) const
+    {
+        return i >= j ? index(i, j) : index(j, i);
+    }
+
+    /**
+     * @brief
+     * Renvoie l'apparentement entre deux individus, dans n'importe quel ordre.
+     *
+     * @param i     La position absolue du premier individu
+     * @param j     La position absolue du second individu
+     */
+    relatedness_t get(int i, int j) const
+    {
+        return values[position(i, j)];
+    }
+
+    /**
+     * @brief
+     * Renvoie la première colonne stockée de la ligne i
+     * (le premier individu du patch le plus à gauche dans la bande).
+     *
+     * @param i     Le numéro de la ligne
+     */
+    int firstColumn(int i) const
+    {
+        return first[i];
+    }
+
+    /**
+     * @brief
+     * Renvoie la ligne i, à partir de la colonne firstColumn(i).
+     *
+     * @param i     La position absolue de l'individu
+     */
+    relatedness_t* row(int i)
+    {
+        return values + start[i];
+    }
+
+    const relatedness_t* row(int i) const
+    {
+        return values + start[i];
+    }
+
+    /**
+     * @brief
+     * Méthode qui calcule une portion de ligne de la nouvelle matrice d'apparentement
+     * (voir RelatednessMatrix::sumParents).
+     *
+     * @param mother    La mère de l'individu de la ligne
+     * @param father    Le père de l'individu de la ligne
+     * @param mothers   Les mères des individus des colonnes
+     * @param fathers   Les pères des individus des colonnes
+     * @param n         Le nombre de colonnes à calculer
+     * @param scale     Le facteur 1 - mitigateRelatedness
+     * @param out       Le début de la portion de ligne
+     */
+    void sumParents(int mother, int father, const int* mothers, const int* fathers, int n, double scale, relatedness_t* out) const;
+
+    /** @brief Le début du bloc de mémoire (la valeur de fond est à la position count()) */
+    relatedness_t* data(void)
+    {
+        return values;
+    }
+
+    const relatedness_t* data(void) const
+    {
+        return values;
+    }
+
+    /** @brief La valeur de fond des paires hors de la bande */
+    relatedness_t background(void) const
+    {
+        return values[nValues];
+    }
+
+    /**
+     * @brief
+     * Méthode qui change la valeur de fond des paires hors de la bande.
+     *
+     * @param value     La nouvelle valeur
+     */
+    void setBackground(relatedness_t value)
+    {
+        values[nValues] = value;
+    }
+
+    /** @brief Le nombre d'éléments stockés (sans la valeur de fond) */
+    std::size_t count(void) const
+    {
+        return nValues;
+    }
+
+    /**
+     * @brief
+     * Méthode qui échange le contenu de deux matrices (seuls les pointeurs sont échangés).
+     *
+     * @param other     L'autre matrice
+     */
+    void swap(BandedRelatednessMatrix& other);
+
+    /**
+     * @brief
+     * Méthode qui calcule la mémoire occupée par une matrice en bande.
+     *
+     * @param K     La capacité d'accueil de chaque patch
+     * @param band  La distance maximale (en patchs) des paires stockées
+     *
+     * @return      La mémoire, en octets
+     */
+    static double memory(const std::vector<int>& K, int band);
+
+private:
+
+    relatedness_t* values; /**< @brief Le bloc de mémoire, avec la valeur de fond à la fin */
+    int n; /**< @brief Le nombre d'individus */
+    int band; /**< @brief La distance maximale des paires stockées */
+    std::size_t nValues; /**< @brief Le nombre d'éléments stockés */
+    std::size_t bytes; /**< @brief La taille du bloc de mémoire */
+
+    std::vector<std::size_t> start; /**< @brief La position de chaque ligne */
+    std::vector<int> first; /**< @brief La première colonne stockée de chaque ligne */
+
+    /** @brief Méthode qui rend la mémoire au système. */
+    void release(void);
+};
+
+#endif // RELATEDNESS_H_INCLUDED
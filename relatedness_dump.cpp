@@ -0,0 +1,315 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <utility>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "relatedness_dump.h"
+
+namespace
+{
+    const char magic[] = "PLRM";
+
+    const std::uint32_t version = 1;
+
+    /* La taille de l'entête, et l'alignement du triangle. */
+    const std::size_t headerBytes = 64;
+
+    /* Ajoute la représentation mémoire d'une valeur à la fin d'un tampon. */
+    template <typename T>
+    void put(std::string& buffer, T value)
+    {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /* Lit une valeur à la position pos du fichier projeté et avance pos. */
+    template <typename T>
+    T load(const unsigned char* data, std::size_t& pos)
+    {
+        T value;
+
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+
+        return value;
+    }
+
+    std::size_t alignUp(std::size_t pos)
+    {
+        return (pos + headerBytes - 1)/headerBytes*headerBytes;
+    }
+}
+
+void RelatednessDump::writeFile(const std::string& path, int gen, const std::vector<int>& firstOfPatch, int band,
+                                relatedness_t background, const std::vector<std::uint32_t>& firstColumns,
+                                const relatedness_t* values, std::size_t count)
+{
+    int i = 0;
+    int NPatch = int(firstOfPatch.size()) - 1;
+    std::size_t dataOffset = alignUp(headerBytes + (NPatch + 1 + firstColumns.size())*sizeof(std::uint32_t));
+    std::string buffer;
+
+    buffer.reserve(dataOffset);
+
+    buffer.append(magic, 4);
+    put<std::uint32_t>(buffer, version);
+    put<std::uint32_t>(buffer, sizeof(relatedness_t));
+    put<std::int32_t>(buffer, gen);
+    put<std::uint32_t>(buffer, firstOfPatch.back());
+    put<std::uint32_t>(buffer, NPatch);
+    put<std::int32_t>(buffer, band);
+    put<std::uint32_t>(buffer, 0);
+    put<double>(buffer, background);
+    put<std::uint64_t>(buffer, count);
+    put<std::uint64_t>(buffer, dataOffset);
+    buffer.resize(headerBytes, '\0');
+
+    for(i=0; i<=NPatch; i++)
+    {
+        put<std::uint32_t>(buffer, firstOfPatch[i]);
+    }
+
+    buffer.append(reinterpret_cast<const char*>(firstColumns.data()), firstColumns.size()*sizeof(std::uint32_t));
+    buffer.resize(dataOffset, '\0');
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    file.write(buffer.data(), buffer.size());
+
+    /* Le triangle part d'un seul bloc, sans conversion. */
+    file.write(reinterpret_cast<const char*>(values), count*sizeof(relatedness_t));
+}
+
+RelatednessDumpReader::RelatednessDumpReader(void)
+{
+    mapped = nullptr;
+    mappedBytes = 0;
+
+    gen = 0;
+    n = 0;
+    band = -1;
+    bytesPerValue = sizeof(double);
+    backgroundValue = 0;
+
+    triangle = nullptr;
+}
+
+RelatednessDumpReader::~RelatednessDumpReader()
+{
+    release();
+}
+
+void RelatednessDumpReader::release(void)
+{
+    if(mapped)
+    {
+        munmap(const_cast<unsigned char*>(mapped), mappedBytes);
+    }
+
+    mapped = nullptr;
+    mappedBytes = 0;
+    triangle = nullptr;
+}
+
+bool RelatednessDumpReader::open(const std::string& path)
+{
+    int i = 0;
+    int fd = 0;
+    struct stat info;
+    void* block = nullptr;
+    std::size_t pos = 0;
+    std::uint32_t fileVersion = 0, fileKtot = 0, NPatch = 0;
+    std::uint64_t count = 0, dataOffset = 0;
+
+    release();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+
+    if(fd < 0)
+    {
+        return false;
+    }
+
+    if(fstat(fd, &info) != 0 || std::size_t(info.st_size) < headerBytes)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    mappedBytes = info.st_size;
+    block = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+
+    /* La projection reste valable une fois le fichier fermé. */
+    ::close(fd);
+
+    if(block == MAP_FAILED)
+    {
+        mappedBytes = 0;
+        return false;
+    }
+
+    mapped = static_cast<const unsigned char*>(block);
+
+    if(std::memcmp(mapped, magic, 4) != 0)
+    {
+        release();
+        return false;
+    }
+
+    pos = 4;
+    fileVersion = load<std::uint32_t>(mapped, pos);
+    bytesPerValue = load<std::uint32_t>(mapped, pos);
+    gen = load<std::int32_t>(mapped, pos);
+    fileKtot = load<std::uint32_t>(mapped, pos);
+    NPatch = load<std::uint32_t>(mapped, pos);
+    band = load<std::int32_t>(mapped, pos);
+    load<std::uint32_t>(mapped, pos);
+    backgroundValue = load<double>(mapped, pos);
+    count = load<std::uint64_t>(mapped, pos);
+    dataOffset = load<std::uint64_t>(mapped, pos);
+
+    n = fileKtot;
+
+    if(fileVersion != version || (bytesPerValue != sizeof(float) && bytesPerValue != sizeof(double)) ||
+       dataOffset < headerBytes + (std::uint64_t(NPatch) + 1 + fileKtot)*sizeof(std::uint32_t) ||
+       dataOffset + count*bytesPerValue > mappedBytes)
+    {
+        release();
+        return false;
+    }
+
+    pos = headerBytes;
+    patchStart.resize(NPatch + 1);
+
+    for(i=0; i<=int(NPatch); i++)
+    {
+        patchStart[i] = load<std::uint32_t>(mapped, pos);
+    }
+
+    /* Les positions des lignes se déduisent de leur première colonne. */
+    first.resize(n);
+    start.resize(n + 1);
+    start[0] = 0;
+
+    for(i=0; i<n; i++)
+    {
+        first[i] = load<std::uint32_t>(mapped, pos);
+
+        if(first[i] > i)
+        {
+            release();
+            return false;
+        }
+
+        start[i + 1] = start[i] + (i - first[i] + 1);
+    }
+
+    if(start[n] != count || patchStart.back() != n)
+    {
+        release();
+        return false;
+    }
+
+    triangle = mapped + dataOffset;
+
+    return true;
+}
+
+int RelatednessDumpReader::generation(void) const
+{
+    return gen;
+}
+
+int RelatednessDumpReader::size(void) const
+{
+    return n;
+}
+
+int RelatednessDumpReader::patchCount(void) const
+{
+    return int(patchStart.size()) - 1;
+}
+
+int RelatednessDumpReader::bandWidth(void) const
+{
+    return band;
+}
+
+int RelatednessDumpReader::valueSize(void) const
+{
+    return bytesPerValue;
+}
+
+double RelatednessDumpReader::background(void) const
+{
+    return backgroundValue;
+}
+
+int RelatednessDumpReader::firstOfPatch(int idPatch) const
+{
+    return patchStart[idPatch];
+}
+
+double RelatednessDumpReader::at(std::size_t pos) const
+{
+    if(bytesPerValue == sizeof(float))
+    {
+        float value;
+        std::memcpy(&value, triangle + pos*sizeof(float), sizeof(float));
+        return value;
+    }
+
+    double value;
+    std::memcpy(&value, triangle + pos*sizeof(double), sizeof(double));
+    return value;
+}
+
+double RelatednessDumpReader::get(int i, int j) const
+{
+    if(i < j)
+    {
+        std::swap(i, j);
+    }
+
+    if(j < first[i])
+    {
+        return backgroundValue;
+    }
+
+    return at(start[i] + (j - first[i]));
+}
+
+void RelatednessDumpReader::readRow(int i, std::vector<double>& values) const
+{
+    int j = 0;
+
+    values.resize(n);
+
+    for(j=0; j<n; j++)
+    {
+        values[j] = get(i, j);
+    }
+}
+
+void RelatednessDumpReader::readBlock(int patchA, int patchB, std::vector<double>& values) const
+{
+    int i = 0, j = 0;
+    int rows = patchStart[patchA + 1] - patchStart[patchA];
+    int columns = patchStart[patchB + 1] - patchStart[patchB];
+
+    values.resize(std::size_t(rows)*columns);
+
+    for(i=0; i<rows; i++)
+    {
+        for(j=0; j<columns; j++)
+        {
+            values[std::size_t(i)*columns + j] = get(patchStart[patchA] + i, patchStart[patchB] + j);
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#ifndef RELATEDNESS_DUMP_H_INCLUDED
+#define RELATEDNESS_DUMP_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "relatedness.h"
+
+/**
+ * @file
+ *
+ * Format binaire de la matrice d'apparentement (relation_<id>.bin), en petit-boutiste :
+ *
+ * - Entête de 64 octets : "PLRM", version (uint32), taille d'un apparentement en octets (uint32, 4 ou 8),
+ *   génération (int32), nombre d'individus Ktot (uint32), nombre de patchs (uint32),
+ *   largeur de bande (int32, -1 pour la demi-matrice complète), 0 (uint32), valeur de fond (double),
+ *   nombre d'apparentements stockés (uint64), position du triangle (uint64), puis des zéros.
+ * - La position absolue du premier individu de chaque patch, plus Ktot à la fin (NPatch + 1 uint32).
+ * - La première colonne stockée de chaque ligne (Ktot uint32) : toujours 0 pour la demi-matrice complète.
+ * - À une position multiple de 64, le triangle tel qu'il est en mémoire : les lignes les unes après les autres,
+ *   la ligne i allant de sa première colonne stockée jusqu'à la colonne i. Les paires absentes
+ *   (hors de la bande) valent la valeur de fond.
+ *
+ * Le triangle est écrit d'un seul bloc, et le lecteur le projette en mémoire (mmap) :
+ * lire une ligne ou un bloc de patchs ne charge que les pages concernées.
+ */
+
+/**
+ * @brief
+ * Écrit une matrice d'apparentement au format binaire.
+ */
+
+class RelatednessDump
+{
+public:
+
+    /**
+     * @brief
+     * Méthode qui écrit le fichier.
+     *
+     * @param path          Le chemin du fichier
+     * @param gen           La génération
+     * @param firstOfPatch  La position absolue du premier individu de chaque patch, plus Ktot à la fin
+     * @param band          La largeur de bande (-1 pour la demi-matrice complète)
+     * @param background    La valeur des paires hors de la bande
+     * @param matrix        La matrice (RelatednessMatrix ou BandedRelatednessMatrix)
+     */
+    template <typename Matrix>
+    static void write(const std::string& path, int gen, const std::vector<int>& firstOfPatch, int band,
+                      relatedness_t background, const Matrix& matrix)
+    {
+        int i = 0;
+        std::vector<std::uint32_t> firstColumns(matrix.size());
+
+        for(i=0; i<matrix.size(); i++)
+        {
+            firstColumns[i] = matrix.firstColumn(i);
+        }
+
+        writeFile(path, gen, firstOfPatch, band, background, firstColumns, matrix.data(), matrix.count());
+    }
+
+private:
+
+    /**
+     * @brief
+     * Méthode qui écrit l'entête, les tables puis le triangle.
+     *
+     * @param path          Le chemin du fichier
+     * @param gen           La génération
+     * @param firstOfPatch  La position absolue du premier individu de chaque patch, plus Ktot à la fin
+     * @param band          La largeur de bande
+     * @param background    La valeur des paires hors de la bande
+     * @param firstColumns  La première colonne stockée de chaque ligne
+     * @param values        Le triangle
+     * @param count         Le nombre d'apparentements du triangle
+     */
+    static void writeFile(const std::string& path, int gen, const std::vector<int>& firstOfPatch, int band,
+                          relatedness_t background, const std::vector<std::uint32_t>& firstColumns,
+                          const relatedness_t* values, std::size_t count);
+};
+
+/**
+ * @brief
+ * Lit une matrice d'apparentement binaire sans la charger : le fichier est projeté en mémoire
+ * et seules les lignes ou les blocs demandés sont lus.
+ */
+
+class RelatednessDumpReader
+{
+public:
+
+    RelatednessDumpReader(void);
+
+    ~RelatednessDumpReader();
+
+    RelatednessDumpReader(const RelatednessDumpReader&) = delete;
+    RelatednessDumpReader& operator=(const RelatednessDumpReader&) = delete;
+
+    /**
+     * @brief
+     * Méthode qui projette le fichier en mémoire et lit l'entête et les tables.
+     *
+     * @param path  Le chemin du fichier
+     *
+     * @return      Vrai si le fichier est une matrice d'apparentement valide
+     */
+    bool open(const std::string& path);
+
+    /** @brief La génération de la matrice */
+    int generation(void) const;
+
+    /** @brief Le nombre d'individus */
+    int size(void) const;
+
+    /** @brief Le nombre de patchs */
+    int patchCount(void) const;
+
+    /** @brief La largeur de bande (-1 pour la demi-matrice complète) */
+    int bandWidth(void) const;
+
+    /** @brief La taille d'un apparentement en octets (4 ou 8) */
+    int valueSize(void) const;
+
+    /** @brief La valeur des paires hors de la bande */
+    double background(void) const;
+
+    /**
+     * @brief
+     * Renvoie la position absolue du premier individu d'un patch.
+     *
+     * @param idPatch   Le numéro du patch (NPatch donne Ktot)
+     */
+    int firstOfPatch(int idPatch) const;
+
+    /**
+     * @brief
+     * Renvoie l'apparentement entre deux individus, dans n'importe quel ordre.
+     *
+     * @param i     La position absolue du premier individu
+     * @param j     La position absolue du second individu
+     */
+    double get(int i, int j) const;
+
+    /**
+     * @brief
+     * Méthode qui lit la ligne complète d'un individu (ses apparentements avec les Ktot individus).
+     *
+     * @param i         La position absolue de l'individu
+     * @param values    Reçoit les Ktot apparentements
+     */
+    void readRow(int i, std::vector<double>& values) const;
+
+    /**
+     * @brief
+     * Méthode qui lit le bloc des apparentements entre les individus de deux patchs.
+     *
+     * @param patchA    Le patch des lignes
+     * @param patchB    Le patch des colonnes
+     * @param values    Reçoit K(patchA) × K(patchB) apparentements, ligne par ligne
+     */
+    void readBlock(int patchA, int patchB, std::vector<double>& values) const;
+
+private:
+
+    const unsigned char* mapped; /**< @brief Le fichier projeté en mémoire */
+    std::size_t mappedBytes; /**< @brief La taille du fichier */
+
+    int gen; /**< @brief La génération */
+    int n; /**< @brief Le nombre d'individus */
+    int band; /**< @brief La largeur de bande */
+    int bytesPerValue; /**< @brief La taille d'un apparentement */
+    double backgroundValue; /**< @brief La valeur des paires hors de la bande */
+
+    std::vector<int> patchStart; /**< @brief La position absolue du premier individu de chaque patch, plus Ktot */
+    std::vector<int> first; /**< @brief La première colonne stockée de chaque ligne */
+    std::vector<std::size_t> start; /**< @brief La position de chaque ligne dans le triangle */
+    const unsigned char* triangle; /**< @brief Le début du triangle */
+
+    /**
+     * @brief
+     * Renvoie l'apparentement stocké à une position du triangle.
+     *
+     * @param pos   La position
+     */
+    double at(std::size_t pos) const;
+
+    /** @brief Méthode qui libère la projection. */
+    void release(void);
+};
+
+#endif // RELATEDNESS_DUMP_H_INCLUDED
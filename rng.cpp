@@ -0,0 +1,118 @@
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include "rng.h"
+
+const char* randomEngineName(void)
+{
+#if defined(PLANTS_RNG_XOSHIRO)
+    return "xoshiro256++";
+#elif defined(PLANTS_RNG_PCG)
+    return "pcg64";
+#elif defined(PLANTS_RNG_PHILOX)
+    return "philox4x32-10";
+#else
+    return "mt19937_64";
+#endif
+}
+
+void Xoshiro256pp::seed(std::uint64_t seed)
+{
+    int i = 0;
+
+    for(i=0; i<4; i++)
+    {
+        s[i] = splitmix64(seed);
+    }
+}
+
+Xoshiro256pp Xoshiro256pp::stream(std::uint64_t seed, std::uint64_t number)
+{
+    return Xoshiro256pp(mix64(seed + 0x9E3779B97F4A7C15ULL*(number + 1)));
+}
+
+std::ostream& operator<<(std::ostream& out, const Xoshiro256pp& engine)
+{
+    return out << engine.s[0] << ' ' << engine.s[1] << ' ' << engine.s[2] << ' ' << engine.s[3];
+}
+
+std::istream& operator>>(std::istream& in, Xoshiro256pp& engine)
+{
+    return in >> engine.s[0] >> engine.s[1] >> engine.s[2] >> engine.s[3];
+}
+
+void Pcg64::seed(std::uint64_t seed, std::uint64_t number)
+{
+    /* L'initialisation de référence de PCG : l'état part de 0, puis on ajoute la graine. */
+    state = 0;
+    increment = ((unsigned __int128)(number) << 1) | 1;
+    (*this)();
+    state += seed;
+    (*this)();
+}
+
+std::ostream& operator<<(std::ostream& out, const Pcg64& engine)
+{
+    return out << std::uint64_t(engine.state >> 64) << ' ' << std::uint64_t(engine.state) << ' '
+               << std::uint64_t(engine.increment >> 64) << ' ' << std::uint64_t(engine.increment);
+}
+
+std::istream& operator>>(std::istream& in, Pcg64& engine)
+{
+    std::uint64_t words[4] = {0, 0, 0, 0};
+
+    in >> words[0] >> words[1] >> words[2] >> words[3];
+
+    engine.state = (unsigned __int128)(words[0]) << 64 | words[1];
+    engine.increment = (unsigned __int128)(words[2]) << 64 | words[3];
+
+    return in;
+}
+
+void Philox4x32::block(std::uint64_t index, std::uint64_t* result) const
+{
+    int round = 0;
+
+    std::uint32_t c[4] = {std::uint32_t(index), std::uint32_t(index >> 32), std::uint32_t(number), std::uint32_t(number >> 32)};
+    std::uint32_t k[2] = {std::uint32_t(key), std::uint32_t(key >> 32)};
+
+    for(round=0; round<10; round++)
+    {
+        std::uint64_t product0 = std::uint64_t(0xD2511F53U)*c[0];
+        std::uint64_t product1 = std::uint64_t(0xCD9E8D57U)*c[2];
+
+        std::uint32_t next[4] = {std::uint32_t(product1 >> 32) ^ c[1] ^ k[0], std::uint32_t(product1),
+                                 std::uint32_t(product0 >> 32) ^ c[3] ^ k[1], std::uint32_t(product0)};
+
+        c[0] = next[0];
+        c[1] = next[1];
+        c[2] = next[2];
+        c[3] = next[3];
+
+        /* La clé change à chaque tour (constantes de Weyl). */
+        k[0] += 0x9E3779B9U;
+        k[1] += 0xBB67AE85U;
+    }
+
+    result[0] = std::uint64_t(c[1]) << 32 | c[0];
+    result[1] = std::uint64_t(c[3]) << 32 | c[2];
+}
+
+std::ostream& operator<<(std::ostream& out, const Philox4x32& engine)
+{
+    return out << engine.key << ' ' << engine.number << ' ' << engine.counter << ' ' << engine.used;
+}
+
+std::istream& operator>>(std::istream& in, Philox4x32& engine)
+{
+    in >> engine.key >> engine.number >> engine.counter >> engine.used;
+
+    /* Le dernier bloc se recalcule à partir du compteur. */
+    if(engine.used < 2 && engine.counter > 0)
+    {
+        engine.block(engine.counter - 1, engine.out);
+    }
+
+    return in;
+}
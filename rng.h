@@ -0,0 +1,254 @@
+#ifndef RNG_H_INCLUDED
+#define RNG_H_INCLUDED
+
+#include <cstdint>
+#include <random>
+#include <istream>
+#include <ostream>
+
+/**
+ * @file
+ *
+ * Les générateurs de nombres aléatoires du modèle.
+ *
+ * Le générateur est choisi à la compilation :
+ *      (rien)                  std::mt19937_64 (Mersenne Twister, le générateur d'origine)
+ *      -DPLANTS_RNG_XOSHIRO    xoshiro256++
+ *      -DPLANTS_RNG_PCG        PCG64 (XSL-RR 128/64)
+ *      -DPLANTS_RNG_PHILOX     Philox4x32-10 (à compteur)
+ *
+ * Tous sont rejouables à partir de la graine du monde, et chacun sait créer
+ * des flux indépendants les uns des autres à partir d'une même graine (randomStream) :
+ * un par patch et par génération, ce qui rend le résultat indépendant du nombre de threads.
+ */
+
+/** @brief Le finaliseur de splitmix64, qui mélange les bits d'un entier. */
+inline std::uint64_t mix64(std::uint64_t z)
+{
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+}
+
+/** @brief Le générateur splitmix64 : avance x et renvoie le nombre suivant. Il sert à remplir l'état des autres. */
+inline std::uint64_t splitmix64(std::uint64_t& x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+
+    return mix64(x);
+}
+
+/**
+ * @brief
+ * Le générateur xoshiro256++ (Blackman et Vigna) : 32 octets d'état, très rapide.
+ */
+
+class Xoshiro256pp
+{
+public:
+
+    typedef std::uint64_t result_type;
+
+    static constexpr result_type min(void) { return 0; }
+    static constexpr result_type max(void) { return ~result_type(0); }
+
+    explicit Xoshiro256pp(std::uint64_t seed = 0)
+    {
+        this->seed(seed);
+    }
+
+    /** @brief Méthode qui remplit l'état à partir d'une graine (par splitmix64). */
+    void seed(std::uint64_t seed);
+
+    result_type operator()(void)
+    {
+        std::uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        std::uint64_t t = s[1] << 17;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+
+        return result;
+    }
+
+    /**
+     * @brief
+     * Renvoie le flux number de la graine seed.
+     * L'état est rempli à partir d'un mélange de la graine et du numéro du flux.
+     */
+    static Xoshiro256pp stream(std::uint64_t seed, std::uint64_t number);
+
+    friend std::ostream& operator<<(std::ostream& out, const Xoshiro256pp& engine);
+    friend std::istream& operator>>(std::istream& in, Xoshiro256pp& engine);
+
+private:
+
+    std::uint64_t s[4]; /**< @brief L'état */
+
+    static std::uint64_t rotl(std::uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+/**
+ * @brief
+ * Le générateur PCG64 (O'Neill) : congruentiel sur 128 bits, sortie XSL-RR sur 64 bits.
+ * L'incrément (impair) choisit le flux.
+ */
+
+class Pcg64
+{
+public:
+
+    typedef std::uint64_t result_type;
+
+    static constexpr result_type min(void) { return 0; }
+    static constexpr result_type max(void) { return ~result_type(0); }
+
+    explicit Pcg64(std::uint64_t seed = 0, std::uint64_t number = 0)
+    {
+        this->seed(seed, number);
+    }
+
+    /** @brief Méthode qui place le générateur au début du flux number de la graine seed. */
+    void seed(std::uint64_t seed, std::uint64_t number = 0);
+
+    result_type operator()(void)
+    {
+        state = state*multiplier() + increment;
+
+        std::uint64_t xored = std::uint64_t(state >> 64) ^ std::uint64_t(state);
+        int rotation = int(state >> 122);
+
+        return (xored >> rotation) | (xored << ((-rotation) & 63));
+    }
+
+    /** @brief Renvoie le flux number de la graine seed. */
+    static Pcg64 stream(std::uint64_t seed, std::uint64_t number)
+    {
+        return Pcg64(mix64(seed + 0x9E3779B97F4A7C15ULL*(number + 1)), number);
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const Pcg64& engine);
+    friend std::istream& operator>>(std::istream& in, Pcg64& engine);
+
+private:
+
+    unsigned __int128 state; /**< @brief L'état */
+    unsigned __int128 increment; /**< @brief L'incrément, impair, propre au flux */
+
+    static unsigned __int128 multiplier(void)
+    {
+        return (unsigned __int128)(0x2360ED051FC65DA4ULL) << 64 | 0x4385DF649FCCF645ULL;
+    }
+};
+
+/**
+ * @brief
+ * Le générateur à compteur Philox4x32-10 (Salmon et al.).
+ *
+ * Le nombre numéro i du flux f est un chiffrement du compteur (f, i) par la clé (la graine) :
+ * il n'y a pas d'état à faire avancer, créer un flux ne coûte rien et deux flux
+ * ne peuvent pas se recouvrir. Chaque bloc chiffré donne deux nombres de 64 bits.
+ */
+
+class Philox4x32
+{
+public:
+
+    typedef std::uint64_t result_type;
+
+    static constexpr result_type min(void) { return 0; }
+    static constexpr result_type max(void) { return ~result_type(0); }
+
+    explicit Philox4x32(std::uint64_t seed = 0, std::uint64_t number = 0)
+    {
+        this->seed(seed, number);
+    }
+
+    /** @brief Méthode qui place le générateur au début du flux number de la graine seed. */
+    void seed(std::uint64_t seed, std::uint64_t number = 0)
+    {
+        key = seed;
+        this->number = number;
+        counter = 0;
+        used = 2;
+    }
+
+    result_type operator()(void)
+    {
+        if(used == 2)
+        {
+            block(counter++, out);
+            used = 0;
+        }
+
+        return out[used++];
+    }
+
+    /**
+     * @brief
+     * Renvoie le flux number de la graine seed.
+     * Le compteur 0 reste au générateur créé avec la seule graine (celui de la pollinisation).
+     */
+    static Philox4x32 stream(std::uint64_t seed, std::uint64_t number)
+    {
+        return Philox4x32(seed, number + 1);
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const Philox4x32& engine);
+    friend std::istream& operator>>(std::istream& in, Philox4x32& engine);
+
+private:
+
+    std::uint64_t key; /**< @brief La clé (la graine) */
+    std::uint64_t number; /**< @brief Le numéro du flux (moitié haute du compteur) */
+    std::uint64_t counter; /**< @brief Le prochain bloc à chiffrer (moitié basse du compteur) */
+    std::uint64_t out[2]; /**< @brief Le dernier bloc chiffré */
+    int used; /**< @brief Le nombre de valeurs du dernier bloc déjà rendues */
+
+    /** @brief Méthode qui chiffre le bloc index du flux (10 tours). */
+    void block(std::uint64_t index, std::uint64_t* result) const;
+};
+
+#if defined(PLANTS_RNG_XOSHIRO)
+typedef Xoshiro256pp RandomEngine;
+#elif defined(PLANTS_RNG_PCG)
+typedef Pcg64 RandomEngine;
+#elif defined(PLANTS_RNG_PHILOX)
+typedef Philox4x32 RandomEngine;
+#else
+/** @brief Le générateur utilisé par le modèle */
+typedef std::mt19937_64 RandomEngine;
+#endif
+
+/** @brief Le nom du générateur utilisé, noté dans les instantanés et le banc d'essai */
+const char* randomEngineName(void);
+
+/**
+ * @brief
+ * Fonction qui renvoie le flux number de la graine seed.
+ * Les flux d'une même graine sont indépendants les uns des autres.
+ *
+ * @param seed      La graine
+ * @param number    Le numéro du flux
+ *
+ * @return          Le générateur, au début du flux
+ */
+inline RandomEngine randomStream(std::uint64_t seed, std::uint64_t number)
+{
+#if defined(PLANTS_RNG_XOSHIRO) || defined(PLANTS_RNG_PCG) || defined(PLANTS_RNG_PHILOX)
+    return RandomEngine::stream(seed, number);
+#else
+    /* Mersenne Twister n'a pas de flux : la graine est mélangée avec le numéro du flux. */
+    return RandomEngine(mix64(seed + 0x9E3779B97F4A7C15ULL*(number + 1)));
+#endif
+}
+
+#endif // RNG_H_INCLUDED
@@ -1,18 +1,13 @@
 #!/bin/bash
-wait_x_hours=2.5
 Replicates=10
 WorldId=0
 
-for i in {0..32}
-do
-	while read line
-	do
-		for ((i=0; i<Replicates; i++))
-		do
-			nohup time ./model $WorldId $line &
-			((WorldId++))
-		done
-	done < config_${i}.txt
-
-	sleep ${wait_x_hours}h
-done
\ No newline at end of file
+# Tous les mondes de tous les fichiers de configuration sont simulés par un seul processus,
+# sur autant de threads que de coeurs et dans la limite de la mémoire disponible.
+# Les identifiants se suivent : fichier par fichier, ligne par ligne, réplicat par réplicat.
+# Avec Precision > 0, chaque point s'arrête dès que la moyenne de s et celle de d sont connues
+# à ±Precision près (intervalle à 95 %), après au moins MinReplicates réplicats ;
+# Replicates devient un plafond. Le résumé des points est dans sweep_${WorldId}.txt.
+Precision=0
+MinReplicates=3
+nohup time ./model --sweep ${Replicates} ${WorldId} config_{0..32}.txt ci=${Precision} min=${MinReplicates} > sweep.log 2>&1 &
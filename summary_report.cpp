@@ -0,0 +1,83 @@
+#include <vector>
+#include <ostream>
+#include <algorithm>
+
+#include "summary_report.h"
+
+TraitSummary::TraitSummary(void)
+{
+    reset(0);
+}
+
+void TraitSummary::reset(int bins)
+{
+    n = 0;
+    m = 0;
+    m2 = 0;
+    lowest = 0;
+    highest = 0;
+    counts.assign(bins, 0);
+}
+
+void TraitSummary::add(double x)
+{
+    int bins = counts.size();
+
+    n++;
+
+    /* Welford : la moyenne et la somme des carrés des écarts sont mises à jour ensemble,
+    sans la perte de précision de la somme des carrés. */
+    double delta = x - m;
+    m += delta/n;
+    m2 += delta*(x - m);
+
+    lowest = (n == 1) ? x : std::min(lowest, x);
+    highest = (n == 1) ? x : std::max(highest, x);
+
+    if(bins > 0)
+    {
+        counts[std::min(std::max(int(x*bins), 0), bins - 1)]++;
+    }
+}
+
+int TraitSummary::count(void) const
+{
+    return n;
+}
+
+double TraitSummary::mean(void) const
+{
+    return m;
+}
+
+double TraitSummary::variance(void) const
+{
+    return (n > 1) ? m2/n : 0;
+}
+
+double TraitSummary::min(void) const
+{
+    return lowest;
+}
+
+double TraitSummary::max(void) const
+{
+    return highest;
+}
+
+const std::vector<int>& TraitSummary::histogram(void) const
+{
+    return counts;
+}
+
+void TraitSummary::write(std::ostream& out) const
+{
+    int i = 0;
+
+    out << m << '\t' << variance() << '\t' << lowest << '\t' << highest << '\t';
+
+    for(i=0; i<int(counts.size()); i++)
+    {
+        out << (i > 0 ? "," : "") << counts[i];
+    }
+}
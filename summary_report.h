@@ -0,0 +1,84 @@
+#ifndef SUMMARY_REPORT_H_INCLUDED
+#define SUMMARY_REPORT_H_INCLUDED
+
+#include <vector>
+#include <ostream>
+
+/**
+ * @file
+ *
+ * Rapport résumé (report=summary, report_<id>.txt) : une ligne par patch et par génération rapportée,
+ * séparée par des tabulations :
+ *
+ *      Gen  Patch  N  puis, pour s, d et f : moyenne  variance  min  max  histogramme
+ *
+ * L'histogramme compte les individus dans chacune des classes de même largeur entre 0 et 1
+ * (bins=N, 10 par défaut), séparés par des virgules ; la valeur 1 tombe dans la dernière classe.
+ */
+
+/**
+ * @brief
+ * Résume un trait en un seul passage sur la population : moyenne et variance (algorithme de Welford),
+ * minimum, maximum et histogramme à classes fixes entre 0 et 1.
+ */
+
+class TraitSummary
+{
+public:
+
+    TraitSummary(void);
+
+    /**
+     * @brief
+     * Méthode qui vide le résumé. La mémoire de l'histogramme est gardée.
+     *
+     * @param bins  Le nombre de classes de l'histogramme
+     */
+    void reset(int bins);
+
+    /**
+     * @brief
+     * Méthode qui ajoute une valeur au résumé.
+     *
+     * @param x     La valeur du trait, entre 0 et 1
+     */
+    void add(double x);
+
+    /** @brief Le nombre de valeurs ajoutées */
+    int count(void) const;
+
+    /** @brief La moyenne des valeurs */
+    double mean(void) const;
+
+    /** @brief La variance des valeurs (divisée par n, 0 s'il y a moins de deux valeurs) */
+    double variance(void) const;
+
+    /** @brief La plus petite valeur (0 sans valeur) */
+    double min(void) const;
+
+    /** @brief La plus grande valeur (0 sans valeur) */
+    double max(void) const;
+
+    /** @brief Le nombre de valeurs dans chaque classe */
+    const std::vector<int>& histogram(void) const;
+
+    /**
+     * @brief
+     * Méthode qui écrit la moyenne, la variance, le minimum, le maximum et l'histogramme,
+     * séparés par des tabulations.
+     *
+     * @param out   Le flux où écrire
+     */
+    void write(std::ostream& out) const;
+
+private:
+
+    int n; /**< @brief Le nombre de valeurs */
+    double m; /**< @brief La moyenne courante */
+    double m2; /**< @brief La somme des carrés des écarts à la moyenne courante */
+    double lowest; /**< @brief Le minimum */
+    double highest; /**< @brief Le maximum */
+    std::vector<int> counts; /**< @brief L'histogramme */
+};
+
+#endif // SUMMARY_REPORT_H_INCLUDED
@@ -0,0 +1,213 @@
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <functional>
+
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int nThreads)
+{
+    int i = 0;
+
+    stop = false;
+    round = 0;
+    busy = 0;
+
+    function = nullptr;
+    task = nullptr;
+    nTasks = 0;
+    next = 0;
+
+    queued = 0;
+    pending = 0;
+    nextQueue = 0;
+
+    if(nThreads <= 0)
+    {
+        nThreads = std::thread::hardware_concurrency();
+    }
+
+    /* Le thread appelant compte pour un. */
+    for(i=1; i<nThreads; i++)
+    {
+        queues.emplace_back(new JobQueue);
+    }
+
+    for(i=1; i<nThreads; i++)
+    {
+        workers.emplace_back(&ThreadPool::loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    wake.notify_all();
+
+    for(std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+int ThreadPool::size(void) const
+{
+    return int(workers.size()) + 1;
+}
+
+void ThreadPool::run(int n, TaskFunction function, const void* task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        this->function = function;
+        this->task = task;
+        nTasks = n;
+        next = 0;
+        busy = int(workers.size());
+        round++;
+    }
+
+    wake.notify_all();
+
+    work(0);
+
+    /* On attend que les autres aient terminé leur dernière tâche. */
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]{ return busy == 0; });
+}
+
+void ThreadPool::work(int worker)
+{
+    int i = 0;
+
+    while((i = next.fetch_add(1)) < nTasks)
+    {
+        function(task, i, worker);
+    }
+}
+
+void ThreadPool::submit(std::function<void(void)> job)
+{
+    if(workers.empty())
+    {
+        job();
+        return;
+    }
+
+    JobQueue& queue = *queues[nextQueue%queues.size()];
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        nextQueue++;
+        pending++;
+        queued++;
+    }
+
+    wake.notify_one();
+}
+
+void ThreadPool::wait(void)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]{ return pending == 0; });
+}
+
+bool ThreadPool::take(int worker, std::function<void(void)>& job)
+{
+    int i = 0;
+    int nQueues = queues.size();
+
+    /* D'abord la dernière tâche de sa propre file, puis la plus ancienne des autres. */
+    for(i=0; i<nQueues; i++)
+    {
+        JobQueue& queue = *queues[(worker - 1 + i)%nQueues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if(!queue.jobs.empty())
+        {
+            if(i == 0)
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            }
+            else
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+
+            queued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::loop(int worker)
+{
+    unsigned long seen = 0;
+
+    while(true)
+    {
+        bool inLoop = false;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen]{ return stop || round != seen || queued > 0; });
+
+            if(stop)
+            {
+                return;
+            }
+
+            if(round != seen)
+            {
+                seen = round;
+                inLoop = true;
+            }
+        }
+
+        if(inLoop)
+        {
+            work(worker);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy--;
+            }
+
+            finished.notify_one();
+            continue;
+        }
+
+        std::function<void(void)> job;
+
+        if(take(worker, job))
+        {
+            job();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+
+            if(pending == 0)
+            {
+                idle.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,168 @@
+#ifndef THREAD_POOL_H_INCLUDED
+#define THREAD_POOL_H_INCLUDED
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <functional>
+
+/**
+ * @file
+ */
+
+/**
+ * @brief
+ * Groupe de threads qui exécutent des boucles parallèles.
+ *
+ * Le thread appelant participe au calcul (il est le travailleur 0).
+ * Les indices de la boucle sont distribués dynamiquement dans l'ordre
+ * croissant : pour équilibrer la charge, il suffit de donner les tâches
+ * les plus longues en premier.
+ *
+ * Le groupe peut aussi exécuter des tâches indépendantes (submit) :
+ * chaque thread de travail a sa propre file, et vole les tâches
+ * des autres files quand la sienne est vide.
+ * Une boucle parallèle attend tous les threads : il ne faut pas
+ * en lancer une pendant que des tâches longues sont en cours.
+ */
+
+class ThreadPool
+{
+public:
+
+    /**
+     * @brief
+     * Constructeur du groupe de threads
+     *
+     * @param nThreads  Le nombre total de threads, appelant compris (0 = autant que de coeurs).
+     */
+    ThreadPool(int nThreads);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** @brief Le nombre total de threads, appelant compris */
+    int size(void) const;
+
+    /**
+     * @brief
+     * Méthode qui exécute task(index, worker) pour chaque index de 0 à n - 1
+     * puis attend que toutes les tâches soient terminées.
+     *
+     * @param n         Le nombre de tâches
+     * @param task      La tâche, qui reçoit son indice et le numéro du travailleur (de 0 à size() - 1)
+     */
+    template <typename Task>
+    void parallelFor(int n, const Task& task)
+    {
+        if(workers.empty() || n <= 1)
+        {
+            for(int i=0; i<n; i++)
+            {
+                task(i, 0);
+            }
+
+            return;
+        }
+
+        run(n, &ThreadPool::call<Task>, &task);
+    }
+
+    /**
+     * @brief
+     * Méthode qui confie une tâche indépendante aux threads de travail.
+     *
+     * S'il n'y a aucun thread de travail, la tâche est exécutée immédiatement.
+     *
+     * @param job   La tâche
+     */
+    void submit(std::function<void(void)> job);
+
+    /** @brief Méthode qui attend la fin de toutes les tâches confiées par submit. */
+    void wait(void);
+
+private:
+
+    /** @brief La file de tâches d'un thread de travail */
+    typedef struct _JobQueue_
+    {
+        std::mutex mutex;
+        std::deque<std::function<void(void)>> jobs;
+    } JobQueue;
+
+    /**
+     * @brief
+     * Méthode qui prend une tâche dans la file du travailleur,
+     * ou à défaut dans celle d'un autre.
+     *
+     * @param worker    Le numéro du travailleur
+     * @param job       La tâche prise
+     *
+     * @return          Vrai si une tâche a été prise
+     */
+    bool take(int worker, std::function<void(void)>& job);
+
+    /** @brief Type d'une tâche dont on a effacé le type */
+    typedef void (*TaskFunction)(const void* task, int index, int worker);
+
+    template <typename Task>
+    static void call(const void* task, int index, int worker)
+    {
+        (*static_cast<const Task*>(task))(index, worker);
+    }
+
+    /**
+     * @brief
+     * Méthode qui publie une boucle aux travailleurs et y participe.
+     *
+     * @param n         Le nombre de tâches
+     * @param function  La fonction qui exécute une tâche
+     * @param task      Le contexte de la tâche
+     */
+    void run(int n, TaskFunction function, const void* task);
+
+    /**
+     * @brief
+     * Méthode qui prend des indices de la boucle courante jusqu'à épuisement.
+     *
+     * @param worker    Le numéro du travailleur
+     */
+    void work(int worker);
+
+    /**
+     * @brief
+     * Boucle principale d'un thread de travail.
+     *
+     * @param worker    Le numéro du travailleur
+     */
+    void loop(int worker);
+
+    std::vector<std::thread> workers; /**< @brief Les threads de travail (sans l'appelant) */
+
+    std::mutex mutex;
+    std::condition_variable wake; /**< @brief Réveille les travailleurs quand une boucle est publiée */
+    std::condition_variable finished; /**< @brief Réveille l'appelant quand tous ont fini */
+
+    bool stop; /**< @brief Demande l'arrêt des threads */
+    unsigned long round; /**< @brief Numéro de la boucle publiée */
+    int busy; /**< @brief Le nombre de travailleurs encore occupés par la boucle */
+
+    TaskFunction function; /**< @brief La boucle courante */
+    const void* task; /**< @brief Le contexte de la boucle courante */
+    int nTasks; /**< @brief Le nombre d'indices de la boucle courante */
+    std::atomic<int> next; /**< @brief Le prochain indice à distribuer */
+
+    std::vector<std::unique_ptr<JobQueue>> queues; /**< @brief Une file de tâches par thread de travail */
+    std::atomic<int> queued; /**< @brief Le nombre de tâches en attente dans les files */
+    int pending; /**< @brief Le nombre de tâches pas encore terminées */
+    unsigned int nextQueue; /**< @brief La file qui recevra la prochaine tâche */
+    std::condition_variable idle; /**< @brief Réveille wait() quand toutes les tâches sont terminées */
+};
+
+#endif // THREAD_POOL_H_INCLUDED
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../relatedness_dump.h"
+
+/**
+ * @file
+ *
+ * Lecteur de la matrice d'apparentement binaire (relation_<id>.bin, relation=binary ou dump=N).
+ *
+ * Usage :
+ *      relatedness_reader relation_0.bin               réécrit toute la matrice au format texte habituel
+ *      relatedness_reader relation_0.bin --info        génération, nombre d'individus, patchs, bande
+ *      relatedness_reader relation_0.bin --row 120     la ligne complète de l'individu 120 (position absolue)
+ *      relatedness_reader relation_0.bin --block 3 4   le bloc des individus du patch 3 (lignes) et du patch 4 (colonnes)
+ *
+ * Seules les pages du fichier qui contiennent les valeurs demandées sont lues.
+ */
+
+namespace
+{
+    /* Lit un entier en argument, entre min et max - 1. */
+    bool parseIndex(const char* arg, int max, int& value)
+    {
+        return bool(std::istringstream(arg) >> value) && value >= 0 && value < max;
+    }
+
+    void writeValues(const std::vector<double>& values, int columns)
+    {
+        size_t i = 0;
+
+        for(i=0; i<values.size(); i++)
+        {
+            std::cout << values[i] << ((i + 1)%columns == 0 ? '\n' : '\t');
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    RelatednessDumpReader reader;
+    std::vector<double> values;
+    int i = 0, j = 0, k = 0;
+
+    if(argc < 2 || !reader.open(argv[1]))
+    {
+        std::cerr << "Usage : " << argv[0] << " relation_<id>.bin [--info | --row <individu> | --block <patch> <patch>]" << std::endl;
+        return 1;
+    }
+
+    if(argc >= 3 && std::string(argv[2]) == "--info")
+    {
+        std::cout << "Génération=" << reader.generation() << " Individus=" << reader.size()
+                  << " Patchs=" << reader.patchCount() << " Bande=" << reader.bandWidth()
+                  << " Fond=" << reader.background() << " Octets par valeur=" << reader.valueSize() << '\n';
+
+        for(i=0; i<reader.patchCount(); i++)
+        {
+            std::cout << i << '\t' << reader.firstOfPatch(i) << '\t' << reader.firstOfPatch(i + 1) - reader.firstOfPatch(i) << '\n';
+        }
+
+        return 0;
+    }
+
+    if(argc >= 4 && std::string(argv[2]) == "--row")
+    {
+        if(!parseIndex(argv[3], reader.size(), i))
+        {
+            std::cerr << "Individu absent : " << argv[3] << std::endl;
+            return 1;
+        }
+
+        reader.readRow(i, values);
+        writeValues(values, reader.size());
+        return 0;
+    }
+
+    if(argc >= 5 && std::string(argv[2]) == "--block")
+    {
+        if(!parseIndex(argv[3], reader.patchCount(), i) || !parseIndex(argv[4], reader.patchCount(), j))
+        {
+            std::cerr << "Patch absent : " << argv[3] << " ou " << argv[4] << std::endl;
+            return 1;
+        }
+
+        reader.readBlock(i, j, values);
+        writeValues(values, reader.firstOfPatch(j + 1) - reader.firstOfPatch(j));
+        return 0;
+    }
+
+    /* La matrice entière, comme World::writeRelatednesses l'écrit en texte. */
+    std::cout << '\t';
+
+    for(i=0; i<reader.patchCount(); i++)
+    {
+        for(j=0; j<reader.firstOfPatch(i + 1) - reader.firstOfPatch(i); j++)
+        {
+            std::cout << j << '\t';
+        }
+    }
+
+    for(i=0; i<reader.patchCount(); i++)
+    {
+        for(j=0; j<reader.firstOfPatch(i + 1) - reader.firstOfPatch(i); j++)
+        {
+            std::cout << '\n' << j << '\t';
+
+            for(k=0; k<=reader.firstOfPatch(i) + j; k++)
+            {
+                std::cout << reader.get(reader.firstOfPatch(i) + j, k) << '\t';
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "../binary_report.h"
+
+/**
+ * @file
+ *
+ * Lecteur du rapport binaire (report_<id>.bin).
+ *
+ * Usage :
+ *      report_reader report_0.bin              réécrit tout le rapport au format texte habituel
+ *      report_reader report_0.bin --gen 5000   seulement la génération 5000 (accès direct par l'index)
+ *      report_reader report_0.bin --list       liste les générations présentes
+ */
+
+int main(int argc, char *argv[])
+{
+    BinaryReportReader reader;
+    ReportGeneration block;
+
+    if(argc < 2 || !reader.open(argv[1]))
+    {
+        std::cerr << "Usage : " << argv[0] << " report_<id>.bin [--gen <génération> | --list]" << std::endl;
+        return 1;
+    }
+
+    if(argc >= 3 && std::string(argv[2]) == "--list")
+    {
+        for(int gen : reader.generations())
+        {
+            std::cout << gen << '\n';
+        }
+
+        return 0;
+    }
+
+    if(argc >= 4 && std::string(argv[2]) == "--gen")
+    {
+        int gen = 0;
+
+        if(!(std::istringstream(argv[3]) >> gen) || !reader.read(gen, block))
+        {
+            std::cerr << "Génération absente : " << argv[3] << std::endl;
+            return 1;
+        }
+
+        BinaryReportReader::writeText(block, std::cout);
+        return 0;
+    }
+
+    std::cout << reader.header();
+
+    for(int gen : reader.generations())
+    {
+        if(!reader.read(gen, block))
+        {
+            std::cerr << "Bloc illisible pour la génération " << gen << std::endl;
+            return 1;
+        }
+
+        BinaryReportReader::writeText(block, std::cout);
+    }
+
+    return 0;
+}
@@ -7,22 +7,79 @@
 #include <fstream>
 #include <chrono>
 #include <algorithm>
+#include <sstream>
+#include <stdexcept>
 
 #include "world.h"
 #include "patch.h"
 #include "individual.h"
+#include "population.h"
+#include "alias_sampler.h"
+#include "thread_pool.h"
+#include "options.h"
+#include "binary_report.h"
+#include "relatedness.h"
+#include "profile.h"
+#include "writer.h"
+#include "checkpoint.h"
+#include "rng.h"
+#include "dispersal.h"
+#include "relatedness_dump.h"
 
 World::World(int idWorld, int NPatch, double delta, double c, bool relatednessIsManaged, double mitigateRelatedness,
              bool rangeToBeShifted, int shiftFrequency,
              int typeMut, double mu, double sigmaZ, double d_s_relativeMutation, int Kdistr, int Kmin, int Kmax, int sigmaK,
              int Pdistr, double Pmin, double Pmax, double sigmaP, double sInit, double dInit,
              bool convergenceToBeChecked, int NPatchToConverge, int NGenToConverge, double relativeConvergence,
-             double absoluteConvergence, int checkConvergenceFrequency, int NGen, int genReport, bool logPoll_is_to_be_written)
+             double absoluteConvergence, int checkConvergenceFrequency, int NGen, int genReport, bool logPoll_is_to_be_written,
+             const Options& options) : pool(options.threads)
 {
     int i = 0, j = 0;
 
+    this->idWorld = idWorld;
     this->NPatch = NPatch;
 
+    /* Les patchs forment une chaîne, sauf si le nombre de colonnes est donné. */
+    width = NPatch;
+    height = 1;
+    neighbours = options.neighbours;
+
+    kernelType = options.kernel;
+    kernelScale = options.kernelScale;
+    kernelRange = options.kernelRange;
+
+    if(kernelType == geometricKernel && kernelScale < 1)
+    {
+        throw std::runtime_error("kernel=geometric demande scale=1 ou plus (le nombre moyen de pas)");
+    }
+
+    if(options.width > 0)
+    {
+        if(NPatch%options.width != 0)
+        {
+            throw std::runtime_error("le nombre de patchs n'est pas un multiple de width=" + std::to_string(options.width));
+        }
+
+        width = options.width;
+        height = NPatch/width;
+    }
+
+    /* Les distributions linéaires répartissent leurs pas entre les colonnes : il en faut au moins deux. */
+    if(width < 2 && (Kdistr != 0 || Pdistr != 0))
+    {
+        throw std::runtime_error("une distribution linéaire de K ou de P demande au moins deux colonnes de patchs");
+    }
+
+    if(height > 1 && options.relatednessBand >= 0)
+    {
+        throw std::runtime_error("band= ne s'applique qu'à une chaîne de patchs");
+    }
+
+    if(options.kinshipMode == pedigreeKinship && options.relatednessBand >= 0)
+    {
+        throw std::runtime_error("band= ne s'applique pas avec kinship=pedigree");
+    }
+
     this->delta = delta;
     this->c = c;
 
@@ -46,267 +103,346 @@ World::World(int idWorld, int NPatch, double delta, double c, bool relatednessIs
 
     this->NGen = NGen;
     genCount = 0;
+    checkCount = 0;
 
-    n_choose_2 = 0;
+    showProgress = options.progress;
 
-    report.open ("report_" + std::to_string(idWorld) + ".txt");
+    reportFormat = options.reportFormat;
+    histogramBins = options.histogramBins;
+    reportPrecision = options.reportPrecision;
+    reportCompression = options.reportCompression;
     this->genReport = genReport;
 
     this->logPoll_is_to_be_written = logPoll_is_to_be_written;
 
-    if(logPoll_is_to_be_written)
-    {
-        logPoll.open("logPoll_" + std::to_string(idWorld) + ".txt");
-    }
-
-    if(relatednessIsManaged)
-    {
-        relation_report.open("relation_" + std::to_string(idWorld) + ".txt");
-    }
+    profileFrequency = options.profileFrequency;
 
     /* Les lignes suivantes permettent de réserver
     de la mémoire pour éviter les réallocations
     qui peuvent diminuer les performances. */
     patches.reserve(NPatch);
-    juveniles[0].reserve(Kmax);
-    juveniles[1].reserve(Kmax);
 
-    /* Deux vecteurs qui permettent de stocker les valeurs de K et P
-    pour chaque patch avant de construire les patchs. */
-    std::vector<int> list_of_K;
-    std::vector<double> list_of_P;
-    list_of_K.reserve(NPatch);
-    list_of_P.reserve(NPatch);
+    /* Les valeurs de K et P pour chaque patch avant de construire les patchs. */
+    std::vector<int> list_of_K = buildK(NPatch, options.width, Kdistr, Kmin, Kmax, sigmaK);
+    std::vector<double> list_of_P = buildP(NPatch, options.width, Pdistr, Pmin, Pmax, sigmaP);
 
-    if(Kdistr == 0)
+    /* Construction des patchs */
+    int Ktot = 0;
+    double Ptot = 0;
+
+    for(i=0; i<NPatch; i++)
     {
-        for(i=0; i<NPatch; i++)
-        {
-            list_of_K.push_back(GaussDistr(Kmin, Kmax, sigmaK, i));
-        }
+        patches.emplace_back(list_of_P[i], list_of_K[i], Ktot);
+        Ktot += patches[i].K;
+        Ptot += patches[i].p;
     }
-    else
-    {
-        int K_to_reach = 0; // La somme des K si on avait une distribution gaussienne.
 
-        for(i=0; i<NPatch; i++)
-        {
-            K_to_reach += GaussDistr(Kmin, Kmax, sigmaK, i);
-        }
+    /* Construction des populations, dans l'ordre des patchs tant qu'il n'y a pas eu de shift. */
+    populations.resize(NPatch);
+    ringOffset = 0;
+    parentShift = 0;
 
-        double Kstep = (K_to_reach - Kmin*NPatch)/((NPatch - 1)*(0.5 + (NPatch - 1)/2));
-        /* ((NPatch - 1)*(0.5 + (NPatch - 1)/2)) est la somme des entiers de 1 à NPatch - 1
-        Ce nombre correspond aux nombres de fois qu'on doit ajouter Kstep à la population. */
+    /* Les populations et les juvéniles échangent leurs vecteurs à chaque génération. Avec un shift,
+    un vecteur peut servir à n'importe quel patch : chacun est alors dimensionné pour le plus grand. */
+    int capacity = *std::max_element(list_of_K.begin(), list_of_K.end());
 
-        if(Kdistr == 1)
-        {
-            for(i=0; i<NPatch; i++)
-            {
-                list_of_K.push_back(Kmin + i*Kstep);
-            }
-        }
+    for(i=0; i<NPatch; i++)
+    {
+        populations[i].reserve(rangeToBeShifted ? capacity : patches[i].K);
 
-        else
+        for(j=0; j<patches[i].K; j++)
         {
-            for(i=0; i<NPatch; i++)
-            {
-                list_of_K.push_back(Kmin + (30-i)*Kstep);
-            }
+            /* On initialise des individus non consanguins. */
+            populations[i].emplace_back(sInit, dInit, 0);
         }
+
+        patches[i].updateSums(populations[i]);
     }
 
-    if(Pdistr == 0)
+    /* Les vecteurs qui recevront la nouvelle génération de chaque patch. */
+    juveniles.resize(NPatch);
+    patchMothers.resize(NPatch);
+    patchFathers.resize(NPatch);
+    for(i=0; i<NPatch; i++)
     {
-        for(i=0; i<NPatch; i++)
+        juveniles[i].reserve(rangeToBeShifted ? capacity : patches[i].K);
+
+        if(relatednessIsManaged)
         {
-            list_of_P.push_back(GaussDistr(Pmin, Pmax, sigmaP, i));
+            patchMothers[i].reserve(patches[i].K);
+            patchFathers[i].reserve(patches[i].K);
         }
     }
-    else
+
+    /* Les patchs d'où viennent les graines de chaque patch. */
+    DispersalKernel kernel(kernelType, kernelScale, kernelRange, neighbours, width > 1, height > 1);
+    buildSeedSources(width, height, kernel, seedSources, seedShares, firstSeedSource);
+
+    int maxSources = 0;
+    for(i=0; i<NPatch; i++)
     {
-        double P_to_reach = 0; // La somme des P si on avait une distribution gaussienne.
+        maxSources = std::max(maxSources, firstSeedSource[i + 1] - firstSeedSource[i]);
+    }
 
-        for(i=0; i<NPatch; i++)
-        {
-            P_to_reach += GaussDistr(Pmin, Pmax, sigmaP, i);
-        }
+    /* Les vecteurs de travail des threads sont dimensionnés une fois pour toutes d'après
+    le plus grand patch : une génération n'alloue ensuite plus rien sur le tas. */
+    scratch.resize(pool.size());
+    for(GenerationScratch& workerScratch : scratch)
+    {
+        workerScratch.press.reserve(2*capacity);
+        workerScratch.motherSampler.reserve(2*capacity);
 
-        double Pstep = (P_to_reach - Pmin*NPatch)/((NPatch - 1)*(0.5 + (NPatch - 1)/2));
-        /* ((NPatch - 1)*(0.5 + (NPatch - 1)/2)) est la somme des entiers de 1 à NPatch - 1
-        Ce nombre correspond aux nombres de fois qu'on doit ajouter Pstep à la population. */
+        workerScratch.sources.patch.reserve(maxSources);
+        workerScratch.sources.sampler.reserve(maxSources);
+        workerScratch.sources.cumulative.reserve(maxSources);
 
-        if(Pdistr == 1)
-        {
-            for(i=0; i<NPatch; i++)
-            {
-                list_of_P.push_back(Pmin + i*Pstep);
-            }
-        }
+        workerScratch.sMutants.reserve(capacity);
+        workerScratch.dMutants.reserve(capacity);
+        workerScratch.mutantValues.reserve(capacity);
+        workerScratch.mutantNoise.reserve(capacity);
 
-        else
+        if(relatednessIsManaged && options.kinshipMode == exactKinship)
         {
-            for(i=0; i<NPatch; i++)
-            {
-                list_of_P.push_back(Pmin + (30-i)*Pstep);
-            }
+            workerScratch.rows.reserve(Ktot);
         }
     }
 
-    /* Construction des patchs */
-    int Ktot = 0;
-    double Ptot = 0;
-
     for(i=0; i<NPatch; i++)
     {
-        patches.emplace_back(list_of_P[i], list_of_K[i], sInit, dInit, Ktot);
-        Ktot += patches[i].K;
-        Ptot += patches[i].p;
+        patchOrder.push_back(i);
     }
 
-    globalPop.reserve(Ktot);
-    for(i=0; i<NPatch; i++)
+    /* Sur une chaîne, les patchs les plus grands sont créés en premier. */
+    if(height == 1)
     {
-        for(j=0; j<patches[i].K; j++)
+        std::stable_sort(patchOrder.begin(), patchOrder.end(),
+                         [this](int a, int b){ return patches[a].K > patches[b].K; });
+    }
+
+    /* Sur une grille, les patchs sont créés carré par carré : ceux qui se suivent partagent leurs voisins.
+    Avec des milliers de patchs, la distribution dynamique aux threads suffit à équilibrer la charge. */
+    else
+    {
+        int tilesPerColumn = (height + latticeTile - 1)/latticeTile;
+
+        auto tileOf = [this, tilesPerColumn](int idPatch)
         {
-            IndividualPosition InfoToAdd;   //
-            InfoToAdd.patch = i;            // On ne peut pas ajouter l'info dans le vecteur sans la construire avant.
-            InfoToAdd.posInPatch = j;       //
+            return (idPatch/height/latticeTile)*tilesPerColumn + (idPatch%height)/latticeTile;
+        };
 
-            globalPop.push_back(InfoToAdd);
-        }
+        std::stable_sort(patchOrder.begin(), patchOrder.end(),
+                         [&tileOf](int a, int b){ return tileOf(a) < tileOf(b); });
     }
 
-    /* Préparation des vecteurs des moyennes des traits pour vérifier la convergence */
+    /* Les positions absolues ne dépendent que des K, elles ne changeront plus. */
+    for(i=0; i<NPatch; i++)
+    {
+        firstOfPatch.push_back(patches[i].pos_of_first_ind);
+    }
+    firstOfPatch.push_back(Ktot);
+
+    /* Préparation du suivi des moyennes des traits pour vérifier la convergence */
     if(convergenceToBeChecked)
     {
-        n_choose_2 = factorial(NGenToConverge)/(2*factorial(NGenToConverge - 2));
         for(i=0; i<NPatch; i++)
         {
-            patches[i].previous_d_means.assign(NGenToConverge - 1, 0);
-            patches[i].previous_s_means.assign(NGenToConverge - 1, 0);
-
-            for(j=(NGenToConverge - 1); j>0; j--)
-            {
-                patches[i].prev_gens_s_similarity_matrix.emplace_back(j);
-                patches[i].prev_gens_d_similarity_matrix.emplace_back(j);
-            }
+            patches[i].dConvergence.reset(NGenToConverge);
+            patches[i].sConvergence.reset(NGenToConverge);
         }
     }
 
     /* Préparation des matrices d'apparentement si nécessaire */
+    relatednessBand = options.relatednessBand;
+    bandBackground = options.bandBackground;
+    relationFormat = options.relationFormat;
+    dumpFrequency = options.dumpFrequency;
+
+    kinshipMode = options.kinshipMode;
+    pedigreeDepth = options.pedigreeDepth;
+    kinshipSamples = options.kinshipSamples;
+    kinshipError = options.kinshipError;
+
     if(relatednessIsManaged)
     {
-        relatedness[0].reserve(Ktot);
-        relatedness[1].reserve(Ktot);
         fathers.reserve(Ktot);
         mothers.reserve(Ktot);
+        relatednessTiles.reserve(std::min(Ktot, 4*pool.size()) + 1);
+
+        /* Sans matrice, seule la généalogie est gardée. */
+        if(kinshipMode == pedigreeKinship)
+        {
+            pedigree.allocate(pedigreeDepth, firstOfPatch, mitigateRelatedness, options.bandBackground);
+        }
 
-        /* On part d'individus non apparentés. */
-        for(i=0; i<Ktot; i++)
+        /* Les deux matrices sont remplies de zéros : on part d'individus non apparentés. */
+        else if(relatednessBand < 0)
         {
-            /* Pour chacune des deux matrices, on construit Ktot lignes remplies de i+1 zéros. */
-            relatedness[0].emplace_back(i + 1);
-            relatedness[1].emplace_back(i + 1);
+            relatedness.allocate(Ktot, options.hugePages);
+            nextRelatedness.allocate(Ktot, options.hugePages);
 
             /* Pour la première matrice, il faut remplir la diagonale de 0.5. */
-            relatedness[0][i][i] = 0.5;
+            for(i=0; i<Ktot; i++)
+            {
+                relatedness.row(i)[i] = 0.5;
+            }
+        }
+        else
+        {
+            bandedRelatedness.allocate(firstOfPatch, relatednessBand, options.hugePages);
+            nextBandedRelatedness.allocate(firstOfPatch, relatednessBand, options.hugePages);
+
+            for(i=0; i<Ktot; i++)
+            {
+                bandedRelatedness.row(i)[i - bandedRelatedness.firstColumn(i)] = 0.5;
+            }
         }
     }
 
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
+    seed = std::chrono::system_clock::now().time_since_epoch().count();
+    if(options.seedIsSet)
+    {
+        seed = options.seed;
+    }
     generator.seed (seed);
 
-    writeHeaders(Kdistr, Kmin, Kmax, sigmaK, Ktot, Pdistr, Pmin, Pmax, sigmaP, Ptot);
+    checkpointFrequency = options.checkpointFrequency;
+    finished = false;
+
+    if(checkpointFrequency > 0)
+    {
+        installStopHandlers();
+    }
+
+    /* Reprise à partir de l'instantané s'il existe, sinon nouvelle simulation. */
+    if(options.resume && readCheckpoint())
+    {
+        if(finished)
+        {
+            std::cout << "Monde " << idWorld << " déjà terminé" << std::endl;
+        }
+        else
+        {
+            std::cout << "Monde " << idWorld << " repris à la génération " << genCount << std::endl;
+        }
+    }
+    else
+    {
+        openReports();
+        writeHeaders(Kdistr, Kmin, Kmax, sigmaK, Ktot, Pdistr, Pmin, Pmax, sigmaP, Ptot);
+    }
+
+    /* Les rapports sont ouverts : le thread d'écriture peut démarrer. */
+    writer.start(options.asyncWriter ? writerCapacity : 0,
+                 [this](const WriterSnapshot& snapshot){ writeSnapshot(snapshot); });
+
+    /* La graine permet de rejouer exactement la simulation. */
+    std::cout << "Graine du monde " << idWorld << " : " << seed << std::endl;
 }
 
-double World::GaussDistr(double minVal, double maxVal, double sigma, int posPatch)
+void World::openReports(void)
 {
-    return (minVal + ((maxVal - minVal) * exp( - ((posPatch-(NPatch/2))*(posPatch-(NPatch/2))) / (2*sigma*sigma))));
+    if(reportFormat == binaryReport)
+    {
+        binReport.open("report_" + std::to_string(idWorld) + ".bin", reportPrecision, reportCompression);
+    }
+    else
+    {
+        report.open ("report_" + std::to_string(idWorld) + ".txt");
+    }
+
+    if(logPoll_is_to_be_written)
+    {
+        logPoll.open("logPoll_" + std::to_string(idWorld) + ".txt");
+    }
 }
 
-void World::run(int idWorld)
+std::vector<int> World::buildK(int NPatch, int width, int Kdistr, int Kmin, int Kmax, int sigmaK)
 {
-    int i = 0, progress = 0, checkCount = 0;
+    int i = 0;
+
+    /* Une chaîne est une grille d'une seule ligne. */
+    int columns = (width > 0) ? width : NPatch;
+    int rows = NPatch/columns;
 
-    std::cout << "Progression du monde " << idWorld << " :" << std::endl;
-    printProgress(0);
+    std::vector<int> list_of_K;
+    list_of_K.reserve(NPatch);
 
-    for(genCount=0; genCount<=NGen; genCount++)
+    if(Kdistr == 0)
     {
-        if(genCount%genReport == 0)
+        for(i=0; i<NPatch; i++)
         {
-            writeReport();
+            list_of_K.push_back(GaussDistr(columns, rows, Kmin, Kmax, sigmaK, i));
         }
+    }
+    else
+    {
+        /* Les distributions linéaires varient d'une colonne à l'autre, comme sur une chaîne de columns patchs. */
+        int K_to_reach = 0; // La somme des K si on avait une distribution gaussienne.
 
-        for(i=0; i<NPatch; i++)
+        for(i=0; i<columns; i++)
         {
-            patches[i].pollenized = redefinePollination(patches[i].p);
+            K_to_reach += GaussDistr(columns, 1, Kmin, Kmax, sigmaK, i);
         }
 
-        if(logPoll_is_to_be_written)
+        double Kstep = (K_to_reach - Kmin*columns)/((columns - 1)*(0.5 + (columns - 1)/2));
+        /* ((columns - 1)*(0.5 + (columns - 1)/2)) est la somme des entiers de 1 à columns - 1
+        Ce nombre correspond aux nombres de fois qu'on doit ajouter Kstep à la population. */
+
+        if(Kdistr == 1)
         {
-            writeLogPoll();
+            for(i=0; i<NPatch; i++)
+            {
+                list_of_K.push_back(Kmin + (i/rows)*Kstep);
+            }
         }
 
-        if(rangeToBeShifted && genCount%shiftFrequency == 0)
+        else
         {
-            /* Déplacement des populations */
-            for(i=0; i < NPatch - 1; i++)
+            for(i=0; i<NPatch; i++)
             {
-                patches[i].population = patches[i+1].population;
-
-                /* On tue les individus en trop. */
-                while(patches[i].K < int(patches[i].population.size()))
-                {
-                    patches[i].population.pop_back();
-                }
+                list_of_K.push_back(Kmin + (30-i/rows)*Kstep);
             }
+        }
+    }
 
-            /* Le patch de droite (le nouveau) est vidé. */
-            patches[NPatch - 1].population.clear();
+    return list_of_K;
+}
 
-            /* Réévaluer la position du premier individu dans le patch (par rapport à la pop globale). */
-            unsigned int new_pos_first_ind = patches[0].population.size();
-            for(i=1; i<NPatch; i++)
-            {
-                patches[i].pos_of_first_ind = new_pos_first_ind;
-                new_pos_first_ind += patches[i].population.size();
-            }
+std::vector<double> World::buildP(int NPatch, int width, int Pdistr, double Pmin, double Pmax, double sigmaP)
+{
+    int i = 0;
 
-            /* Il faut recréer la globalPop avant de pouvoir créer la nouvelle génération. */
-            globalPop.clear();
+    int columns = (width > 0) ? width : NPatch;
+    int rows = NPatch/columns;
 
-            for(i=0; i<NPatch; i++)
-            {
-                for(int j = 0; j < int(patches[i].population.size()); j++)
-                {
-                    IndividualPosition InfoToAdd;   //
-                    InfoToAdd.patch = i;            // On ne peut pas ajouter l'info dans le vecteur sans la construire avant.
-                    InfoToAdd.posInPatch = j;       //
+    std::vector<double> list_of_P;
+    list_of_P.reserve(NPatch);
 
-                    globalPop.push_back(InfoToAdd);
-                }
-            }
+    if(Pdistr == 0)
+    {
+        for(i=0; i<NPatch; i++)
+        {
+            list_of_P.push_back(GaussDistr(columns, rows, Pmin, Pmax, sigmaP, i));
+        }
+    }
+    else
+    {
+        double P_to_reach = 0; // La somme des P si on avait une distribution gaussienne.
 
-            for(i=0; i<NPatch; i++)
-            {
-                createNextGen(i);
-            }
+        for(i=0; i<columns; i++)
+        {
+            P_to_reach += GaussDistr(columns, 1, Pmin, Pmax, sigmaP, i);
+        }
 
-            /* D'une fois que la nouvelle génération est créée, le monde a retrouvé sa population normale.
-            Il faut donc recréer globalPop une nouvelle fois. */
-            globalPop.clear();
+        double Pstep = (P_to_reach - Pmin*columns)/((columns - 1)*(0.5 + (columns - 1)/2));
+        /* ((columns - 1)*(0.5 + (columns - 1)/2)) est la somme des entiers de 1 à columns - 1
+        Ce nombre correspond aux nombres de fois qu'on doit ajouter Pstep à la population. */
 
+        if(Pdistr == 1)
+        {
             for(i=0; i<NPatch; i++)
             {
-                for(int j = 0; j < int(patches[i].population.size()); j++)
-                {
-                    IndividualPosition InfoToAdd;   //
-                    InfoToAdd.patch = i;            // On ne peut pas ajouter l'info dans le vecteur sans la construire avant.
-                    InfoToAdd.posInPatch = j;       //
-
-                    globalPop.push_back(InfoToAdd);
-                }
+                list_of_P.push_back(Pmin + (i/rows)*Pstep);
             }
         }
 
@@ -314,156 +450,468 @@ void World::run(int idWorld)
         {
             for(i=0; i<NPatch; i++)
             {
-                createNextGen(i);
+                list_of_P.push_back(Pmin + (30-i/rows)*Pstep);
             }
         }
+    }
 
+    return list_of_P;
+}
 
-        if(convergenceToBeChecked && genCount%checkConvergenceFrequency == 0 &&
-           (genCount >= 100000 - (NGenToConverge - 1)*checkConvergenceFrequency))
-        {
-            int sumOfConvergedPatches = 0;
+double World::GaussDistr(int columns, int rows, double minVal, double maxVal, double sigma, int posPatch)
+{
+    /* La distance au milieu, en patchs (sur une chaîne, rows = 1 et dy = 0). */
+    int dx = posPatch/rows - columns/2;
+    int dy = posPatch%rows - rows/2;
 
-            for(i=0; i<NPatch; i++)
-            {
-                sumOfConvergedPatches +=
-                patches[i].check_convergence(checkCount, NGenToConverge, n_choose_2, relativeConvergence, absoluteConvergence);
-            }
+    return (minVal + ((maxVal - minVal) * exp( - (dx*dx + dy*dy) / (2*sigma*sigma))));
+}
 
-            if(sumOfConvergedPatches >= NPatchToConverge)
-            {
-                if(relatednessIsManaged)
-                {
-                    writeRelatednesses();
-                }
+void World::buildSeedSources(int columns, int rows, const DispersalKernel& kernel, std::vector<int>& sources,
+                             std::vector<double>& shares, std::vector<int>& firstSource)
+{
+    int i = 0;
 
-                return; // Si on a rempli le critère de convergence, on arrête la simu.
-            }
+    sources.clear();
+    shares.clear();
+    firstSource.clear();
 
-            checkCount ++;
-        }
+    for(i=0; i<columns*rows; i++)
+    {
+        int x = i/rows, y = i%rows;
+        bool residentAdded = false;
 
-        if(relatednessIsManaged)
+        firstSource.push_back(sources.size());
+
+        for(const DispersalOffset& offset : kernel.offsets())
         {
-            calcNewRelatednesses();
+            /* Le patch lui-même se place entre les décalages négatifs et positifs. */
+            if(!residentAdded && (offset.dx > 0 || (offset.dx == 0 && offset.dy > 0)))
+            {
+                sources.push_back(i);
+                shares.push_back(1);
+                residentAdded = true;
+            }
+
+            if(x + offset.dx >= 0 && x + offset.dx < columns && y + offset.dy >= 0 && y + offset.dy < rows)
+            {
+                sources.push_back(i + offset.dx*rows + offset.dy);
+                shares.push_back(offset.share);
+            }
         }
 
-        /* Indique la progression à l'écran */
-        if (genCount*78/NGen > progress)
+        if(!residentAdded)
         {
-            progress = genCount*78/NGen;
-            printProgress(progress);
+            sources.push_back(i);
+            shares.push_back(1);
         }
     }
-
-    if(relatednessIsManaged)
-    {
-        writeRelatednesses();
-    }
+    firstSource.push_back(sources.size());
 }
 
-void World::createNextGen(int idPatch)
+double World::predictMemory(const std::vector<int>& K, bool relatednessIsManaged, const Options& options)
 {
-    int i = 0;
-
-    /* Pour savoir la taille des vecteurs et ainsi réserver
-    en avance la mémoire pour améliorer les performances. */
-    int memoryToReserve = 2*patches[idPatch].K;
+    int band = options.relatednessBand;
+    int Ktot = 0;
 
-    /* Perment de savoir où commencer le tirage aléatoire des mères. */
-    int firstMother = patches[idPatch].pos_of_first_ind;
+    for(int k : K)
+    {
+        Ktot += k;
+    }
 
-    /* Vecteur qui contient toutes les mères possibles (allof et autof).
-    Elles sont numérotées de firstMother à n.
-    La 1ère mère fait de l'autof, la 2nde allof, 3ème autof, etc. */
-    std::vector<int> mother;
+    /* Les adultes et les juvéniles : trois traits par individu. */
+    double memory = 2.0*Ktot*3*sizeof(double);
 
-    /* Vecteur qui contient toutes les pressions pour un patch
-    (dispersantes des voisins et résidentes du patch local).
-    Les valeurs paires sont issues d'autof.
-    Les valeurs impaires sont issues d'allof. */
-    std::vector<double> press;
+    /* Les instantanés en attente d'écriture : deux traits par individu. */
+    memory += writerCapacity*Ktot*2*sizeof(double);
 
-    /* Selon la position du patch, il faut réserver plus ou moins de mémoire. */
-    if(idPatch != 0)
+    if(relatednessIsManaged)
     {
-        memoryToReserve += 2*patches[idPatch - 1].K;
+        /* La généalogie, ou les deux matrices, complètes ou en bande. */
+        if(options.kinshipMode == pedigreeKinship)
+        {
+            memory += Pedigree::memory(options.pedigreeDepth, Ktot);
+        }
+        else if(band < 0)
+        {
+            memory += 2.0*RelatednessMatrix::memory(Ktot);
+        }
+        else
+        {
+            memory += 2.0*BandedRelatednessMatrix::memory(K, band);
+        }
+
+        /* Les mères et les pères. */
+        memory += 2.0*Ktot*sizeof(int);
+    }
+
+    return memory;
+}
+
+bool World::run(int idWorld)
+{
+    int i = 0, progress = 0;
+
+    /* Un monde repris peut avoir déjà terminé. */
+    if(finished)
+    {
+        return true;
+    }
+
+    int firstGen = genCount;
+    progress = genCount*78/NGen;
+
+    profiler.open(idWorld, pool.size(), profileFrequency);
+
+    if(showProgress)
+    {
+        std::cout << "Progression du monde " << idWorld << " :" << std::endl;
+        printProgress(progress);
+    }
+
+    for(; genCount<=NGen; genCount++)
+    {
+        /* Les instantanés sont pris au début d'une génération. */
+        if(checkpointFrequency > 0)
+        {
+            if(stopRequested())
+            {
+                writeCheckpoint(false);
+                std::cout << "Monde " << idWorld << " arrêté à la génération " << genCount
+                          << ", instantané écrit dans " << checkpointPath() << std::endl;
+                profiler.write(genCount - firstGen);
+                return false;
+            }
+
+            if(genCount != firstGen && genCount%checkpointFrequency == 0)
+            {
+                writeCheckpoint(false);
+            }
+        }
+
+        if(genCount%genReport == 0)
+        {
+            writeReport();
+        }
+
+        if(relatednessIsManaged && kinshipMode == exactKinship && dumpFrequency > 0 && genCount%dumpFrequency == 0)
+        {
+            dumpRelatednesses("relation_" + std::to_string(idWorld) + "_" + std::to_string(genCount) + ".bin");
+        }
+
+        {
+            PROFILE_PHASE(profiler, 0, pollinationPhase);
+
+            for(i=0; i<NPatch; i++)
+            {
+                patches[i].pollenized = redefinePollination(patches[i].p);
+            }
+        }
+
+        if(logPoll_is_to_be_written)
+        {
+            writeLogPoll();
+        }
+
+        if(rangeToBeShifted && genCount%shiftFrequency == 0)
+        {
+            {
+                PROFILE_PHASE(profiler, 0, shiftPhase);
+                shiftRange();
+            }
+
+            createNextGeneration();
+
+            /* La nouvelle génération occupe de nouveau tous les patchs, dans l'ordre de la matrice. */
+            parentShift = 0;
+        }
+
+        else
+        {
+            createNextGeneration();
+        }
+
+
+        if(convergenceToBeChecked && genCount%checkConvergenceFrequency == 0 &&
+           (genCount >= 100000 - (NGenToConverge - 1)*checkConvergenceFrequency))
+        {
+            int sumOfConvergedPatches = 0;
+
+            {
+                PROFILE_PHASE(profiler, 0, convergencePhase);
+
+                for(i=0; i<NPatch; i++)
+                {
+                    sumOfConvergedPatches +=
+                    patches[i].check_convergence(relativeConvergence, absoluteConvergence);
+                }
+            }
+
+            if(sumOfConvergedPatches >= NPatchToConverge)
+            {
+                finish();
+                profiler.write(genCount - firstGen + 1);
+
+                return true; // Si on a rempli le critère de convergence, on arrête la simu.
+            }
+
+            checkCount ++;
+        }
+
+        if(relatednessIsManaged)
+        {
+            calcNewRelatednesses();
+        }
+
+        /* Indique la progression à l'écran */
+        if (showProgress && genCount*78/NGen > progress)
+        {
+            progress = genCount*78/NGen;
+            printProgress(progress);
+        }
+
+        profiler.endGeneration(genCount);
+    }
+
+    finish();
+    profiler.write(genCount - firstGen);
+
+    return true;
+}
+
+void World::finish(void)
+{
+    /* La généalogie ne donne pas de matrice à écrire. */
+    if(relatednessIsManaged && kinshipMode == exactKinship)
+    {
+        writeRelatednesses();
     }
-    if(idPatch != NPatch - 1)
+
+    /* Une reprise de ce monde n'aura plus rien à faire. */
+    if(checkpointFrequency > 0)
     {
-        memoryToReserve += 2*patches[idPatch + 1].K;
+        writeCheckpoint(true);
     }
+}
+
+void World::patchMeans(std::vector<double>& meanS, std::vector<double>& meanD) const
+{
+    int i = 0;
 
-    mother.reserve(memoryToReserve + 1);
-    press.reserve(memoryToReserve);
+    meanS.resize(NPatch);
+    meanD.resize(NPatch);
 
-    if (idPatch != 0)
+    /* Après chaque génération, le patch compte exactement K individus. */
+    for(i=0; i<NPatch; i++)
     {
-        patches[idPatch - 1].getDispPress(delta, c, press);
+        meanS[i] = patches[i].sumS/patches[i].K;
+        meanD[i] = patches[i].sumD/patches[i].K;
+    }
+}
+
+void World::shiftRange(void)
+{
+    int i = 0;
 
-        /* On peut vider le vecteur car il n'est plus utile. */
-        clear_and_freeVector(patches[idPatch - 1].dispSeeds);
+    /* La population du patch i + height (à sa droite) devient celle du patch i,
+    et celles de la colonne de gauche prennent la place de la nouvelle colonne de droite. */
+    ringOffset = (ringOffset + height)%NPatch;
+
+    /* On tue les individus en trop : ce sont les derniers, il n'y a rien à déplacer. */
+    for(i=0; i < NPatch - height; i++)
+    {
+        populationOf(i).truncate(patches[i].K);
+    }
 
-        /* Puisqu'on n'est pas tout à gauche, la première mère devient le premier individu du patch de gauche. */
-        firstMother = patches[idPatch - 1].pos_of_first_ind;
+    /* La colonne de droite (la nouvelle) est vidée. */
+    for(i=NPatch - height; i<NPatch; i++)
+    {
+        populationOf(i).clear();
     }
 
-    patches[idPatch].getResidPress(delta, press);
+    /* Les apparentements des parents sont toujours rangés selon leurs anciens patchs. */
+    parentShift = height;
+}
+
+void World::createNextGeneration(void)
+{
+    int i = 0;
+
+    PROFILE_PHASE(profiler, 0, generationPhase);
+
+    /* Les pressions dispersantes et leur table des alias ne sont calculées qu'une fois par patch,
+    puis partagées par tous les patchs à portée. */
+    pool.parallelFor(NPatch, [this](int idPatch, [[maybe_unused]] int worker)
+    {
+        /* worker ne sert qu'aux mesures (-DPLANTS_PROFILE). */
+        PROFILE_PHASE(profiler, worker, pressurePhase);
+        patches[idPatch].updateDispSeeds(populationOf(idPatch), delta, c);
+    });
+
+    pool.parallelFor(NPatch, [this](int rank, int worker)
+    {
+        createNextGen(patchOrder[rank], worker);
+    });
 
-    if (idPatch != NPatch - 1)
+    /* Toutes les anciennes générations ont servi, on peut les remplacer. */
+    for(i=0; i<NPatch; i++)
     {
-        patches[idPatch + 1].getDispPress(delta, c, press);
+        std::swap(populationOf(i), juveniles[i]);
+        juveniles[i].clear();
     }
 
-    for (i=firstMother; i<firstMother + int(press.size()) + 1; i++)
+    /* Les parents sont rangés dans l'ordre absolu des descendants. */
+    if(relatednessIsManaged)
     {
-        mother.push_back(i);
+        for(i=0; i<NPatch; i++)
+        {
+            mothers.insert(mothers.end(), patchMothers[i].begin(), patchMothers[i].end());
+            fathers.insert(fathers.end(), patchFathers[i].begin(), patchFathers[i].end());
+            patchMothers[i].clear();
+            patchFathers[i].clear();
+        }
     }
+}
+
+void World::createNextGen(int idPatch, int worker)
+{
+    int i = 0;
 
-    /* Objet qui permet de générer des nombres aléatoires pondérés. */
-    std::piecewise_constant_distribution<double> weighted (mother.begin(), mother.end(), press.begin());
+    double sumS = 0, sumD = 0;
+
+    /* Le flux aléatoire propre à ce patch et à cette génération. */
+    RandomEngine patchGen = patchStream(idPatch);
+
+    /* Les patchs d'où viennent les graines, avec la table des alias de chacun. */
+    const SeedSources& sources = scratch[worker].sources;
+
+    {
+        PROFILE_PHASE(profiler, worker, pressurePhase);
+        gatherSeedSources(idPatch, worker);
+    }
 
-    for(i=0; i<patches[idPatch].K; i++)
     {
-        int chosenMother = weighted(generator);
+        PROFILE_PHASE(profiler, worker, offspringPhase);
+
+        {
+            PROFILE_PHASE(profiler, worker, samplingPhase);
+
+            for(i=0; i<patches[idPatch].K; i++)
+            {
+                int patchMother = 0;
+                int chosenSeed = sampleSeed(sources, patchGen, patchMother);
+
+                /* Les propagules paires sont issues d'autof. */
+                bool autof = (chosenSeed%2 == 0);
+
+                /* Chaque mère a deux propagules (autof et allof). */
+                int chosenMother = chosenSeed/2;
+
+                newInd(idPatch, patchMother, chosenMother, autof, patchGen);
 
-        /* Une mère fait de l'autof si elle a la même parité que la première mère. */
-        bool autof = false;
-        if (chosenMother%2 == firstMother%2)
+                /* On ajoute les traits du descendant aux sommes du patch, ce qui évite
+                de parcourir la population pour vérifier la convergence. */
+                sumS += juveniles[idPatch].s[i];
+                sumD += juveniles[idPatch].d[i];
+            }
+        }
+
+        /* Les mutations sont appliquées en une fois à toute la nouvelle génération ;
+        elles corrigent elles-mêmes les sommes. */
         {
-            autof = true;
+            PROFILE_PHASE(profiler, worker, mutationPhase);
+            mutation(juveniles[idPatch], worker, patchGen, sumS, sumD);
         }
+    }
+
+    patches[idPatch].sumS = sumS;
+    patches[idPatch].sumD = sumD;
+}
+
+void World::gatherSeedSources(int idPatch, int worker)
+{
+    int k = 0;
+
+    SeedSources& sources = scratch[worker].sources;
+
+    /* Les pressions résidentes du patch local. Les valeurs paires sont issues d'autof,
+    les valeurs impaires d'allof ; la propagule k correspond à la mère k/2. */
+    std::vector<double>& press = scratch[worker].press;
+    AliasSampler& motherSampler = scratch[worker].motherSampler;
+
+    press.clear();
+    patches[idPatch].getResidPress(populationOf(idPatch), delta, press);
+    motherSampler.build(press);
+
+    /* Les patchs à portée ont déjà leur table des alias (updateDispSeeds) :
+    il ne reste qu'à la pondérer par la part de leurs graines qui arrive ici. */
+    int first = firstSeedSource[idPatch];
+    int NSources = firstSeedSource[idPatch + 1] - first;
+    double total = 0;
 
-        /* Pour reprendre l'id de la mère (on en avait le double car autof et allof). */
-        chosenMother = (firstMother + chosenMother)/2;
+    sources.patch.resize(NSources);
+    sources.sampler.resize(NSources);
+    sources.cumulative.resize(NSources);
 
-        /* Pour les patchs pairs, on met la nouvelle génération dans le 1er vecteur.
-        Pour les patchs impairs, dans le 2nd. */
-        newInd(idPatch%2, chosenMother, autof);
-        mutation(juveniles[idPatch%2][i]);
+    for(k=0; k<NSources; k++)
+    {
+        int source = seedSources[first + k];
+
+        sources.patch[k] = source;
+        sources.sampler[k] = (source == idPatch) ? &motherSampler : &patches[source].dispSampler;
+
+        total += seedShares[first + k]*sources.sampler[k]->total();
+        sources.cumulative[k] = total;
     }
 
-    /* Au premier patch, rien à faire. */
-    if(idPatch != 0)
+    /* Sans aucune pression, toutes les propagules ont la même chance (comme dans une table des alias). */
+    if(total <= 0)
     {
-        patches[idPatch - 1].population = juveniles[(idPatch-1)%2];
-        juveniles[(idPatch-1)%2].clear();
+        for(k=0; k<NSources; k++)
+        {
+            total += sources.sampler[k]->size();
+            sources.cumulative[k] = total;
+        }
     }
 
-    /* Au dernier patch, on remplace la génération. */
-    if(idPatch == NPatch - 1)
+    /* Les patchs sans pression (vides après un shift) ne doivent jamais être tirés, même par arrondi. */
+    sources.last = 0;
+    for(k=1; k<NSources; k++)
     {
-        patches[idPatch].population = juveniles[idPatch%2];
-        juveniles[idPatch%2].clear();
+        if(sources.cumulative[k] > sources.cumulative[k - 1])
+        {
+            sources.last = k;
+        }
     }
 }
 
-void World::newInd(int whr, int mother, bool autof)
+int World::sampleSeed(const SeedSources& sources, RandomEngine& patchGen, int& patchMother) const
+{
+    /* D'abord le patch de la mère : le premier dont la somme cumulée dépasse le tirage. */
+    std::uniform_real_distribution<double> unif(0, sources.cumulative.back());
+    double u = unif(patchGen);
+
+    int k = std::upper_bound(sources.cumulative.begin(), sources.cumulative.begin() + sources.last, u)
+            - sources.cumulative.begin();
+
+    patchMother = sources.patch[k];
+
+    /* Puis la propagule dans ce patch. */
+    return sources.sampler[k]->sample(patchGen);
+}
+
+RandomEngine World::patchStream(int idPatch)
+{
+    /* Chaque couple (génération, patch) a son propre flux. */
+    return randomStream(seed, std::uint64_t(genCount)*NPatch + idPatch);
+}
+
+void World::newInd(int idPatch, int patchMother, int mother_PosInPatch, bool autof, RandomEngine& patchGen)
 {
+    const Population& parents = populationOf(patchMother);
 
-    /* On récupère la position relative de la mère dans son patch. */
-    int patchMother = globalPop[mother].patch;
-    int mother_PosInPatch = globalPop[mother].posInPatch;
+    /* La ligne de la mère dans la matrice d'apparentement des parents. */
+    int motherRow = parentRow(patchMother, mother_PosInPatch);
 
     /* Issue d'autof */
     if(autof)
@@ -472,13 +920,12 @@ void World::newInd(int whr, int mother, bool autof)
 
         if(relatednessIsManaged)
         {
-            f = 0.5 + patches[patchMother].population[mother_PosInPatch].f*0.5;
-            mothers.push_back(mother);
-            fathers.push_back(mother);
+            f = 0.5 + parents.f[mother_PosInPatch]*0.5;
+            patchMothers[idPatch].push_back(motherRow);
+            patchFathers[idPatch].push_back(motherRow);
         }
 
-        juveniles[whr].emplace_back(patches[patchMother].population[mother_PosInPatch].s,
-                                    patches[patchMother].population[mother_PosInPatch].d, f);
+        juveniles[idPatch].emplace_back(parents.s[mother_PosInPatch], parents.d[mother_PosInPatch], f);
 
     }
 
@@ -487,101 +934,150 @@ void World::newInd(int whr, int mother, bool autof)
     {
         double f = 0;
 
-        int father = getFather(patchMother, mother_PosInPatch);
+        int father = getFather(patchMother, mother_PosInPatch, patchGen);
 
         if(relatednessIsManaged)
         {
-            mothers.push_back(mother);
-            fathers.push_back(patches[patchMother].pos_of_first_ind + father);
-            f = relatedness[genCount%2][std::max(fathers.back(), mothers.back())][std::min(fathers.back(), mothers.back())];
+            int fatherRow = parentRow(patchMother, father);
+
+            patchMothers[idPatch].push_back(motherRow);
+            patchFathers[idPatch].push_back(fatherRow);
+            f = parentKinship(fatherRow, motherRow, patchGen);
 
         }
 
-        juveniles[whr].emplace_back(0.5*(patches[patchMother].population[mother_PosInPatch].s +
-                                     patches[patchMother].population[father].s),
-                                    0.5*(patches[patchMother].population[mother_PosInPatch].d +
-                                     patches[patchMother].population[father].d), f);
+        juveniles[idPatch].emplace_back(0.5*(parents.s[mother_PosInPatch] + parents.s[father]),
+                                    0.5*(parents.d[mother_PosInPatch] + parents.d[father]), f);
     }
 }
 
-void World::mutation(Individual& IndToMutate)
+void World::mutation(Population& pop, int worker, RandomEngine& patchGen, double& sumS, double& sumD)
 {
-    std::uniform_real_distribution<double> unif(0, 1);
+    int n = pop.size();
 
-    /* Y a-t-il mutation ? */
-    if(unif(generator) < mu)
+    std::vector<int>& sMutants = scratch[worker].sMutants;
+    std::vector<int>& dMutants = scratch[worker].dMutants;
+    sMutants.clear();
+    dMutants.clear();
+
+    if(mu <= 0)
     {
-        /* Pour «retenir» quel trait doit muter
-        false: d     true: s */
-        bool sWasChosen = false;
-        double trait = IndToMutate.d;
+        return;
+    }
 
+    std::uniform_real_distribution<double> unif(0, 1);
+
+    /* Le nombre de descendants qui ne mutent pas avant le prochain mutant suit une loi
+    géométrique : on saute directement d'un mutant au suivant, sans tirage pour les autres. */
+    bool everyoneMutates = (mu >= 1);
+    std::geometric_distribution<long long> skip(everyoneMutates ? 0.5 : mu);
+
+    for(long long i = everyoneMutates ? 0 : skip(patchGen); i < n; i += 1 + (everyoneMutates ? 0 : skip(patchGen)))
+    {
         /* On choisit quel trait mute */
-        if(unif(generator) >= d_s_relativeMutation)
+        if(unif(patchGen) >= d_s_relativeMutation)
         {
-            trait = IndToMutate.s;
-            sWasChosen = true;
+            sMutants.push_back(i);
         }
-
-        switch(typeMut)
+        else
         {
-            case gaussian:
-                trait = gaussMutation(trait);
-                break;
-
-            case uniform:
-                trait = unifMutation(trait);
-                break;
+            dMutants.push_back(i);
         }
+    }
+
+    mutateTraits(pop.s.data(), sMutants, worker, patchGen, sumS);
+    mutateTraits(pop.d.data(), dMutants, worker, patchGen, sumD);
+}
+
+void World::mutateTraits(double* traits, const std::vector<int>& mutants, int worker, RandomEngine& patchGen,
+                         double& sum)
+{
+    int k = 0;
+    int m = mutants.size();
 
-        if (sWasChosen)
+    if(m == 0)
+    {
+        return;
+    }
+
+    std::vector<double>& values = scratch[worker].mutantValues;
+    std::vector<double>& noise = scratch[worker].mutantNoise;
+    values.resize(m);
+    noise.resize(m);
+
+    for(k=0; k<m; k++)
+    {
+        values[k] = traits[mutants[k]];
+    }
+
+    /* Les tirages d'abord, puis la même transformation pour tous les mutants,
+    dans une boucle sans branchement que le compilateur peut vectoriser. */
+    switch(typeMut)
+    {
+        case gaussian:
         {
-            IndToMutate.s = trait;
+            std::normal_distribution<double> gauss(0, sigmaZ);
+            for(k=0; k<m; k++)
+            {
+                noise[k] = gauss(patchGen);
+            }
+            gaussMutation(values.data(), noise.data(), m);
+            break;
         }
-        else
+
+        case uniform:
         {
-            IndToMutate.d = trait;
+            std::uniform_real_distribution<double> unif(0, 1);
+            for(k=0; k<m; k++)
+            {
+                noise[k] = unif(patchGen);
+            }
+            unifMutation(values.data(), noise.data(), m);
+            break;
         }
     }
+
+    for(k=0; k<m; k++)
+    {
+        sum += values[k] - traits[mutants[k]];
+        traits[mutants[k]] = values[k];
+    }
 }
 
-double World::gaussMutation(double t)
+void World::gaussMutation(double* t, const double* deltaMu, int n) const
 {
-    std::normal_distribution<double> gauss(0,sigmaZ);
-    double deltaMu = gauss(generator);
+    int i = 0;
+
+    for(i=0; i<n; i++)
+    {
+        double em1 = expm1(deltaMu[i]); //expm1(x) renvoie exp(x) - 1.
 
-    return t*exp(deltaMu)/(expm1(deltaMu)*t + 1); //expm1(x) renvoie exp(x) - 1.
+        t[i] = t[i]*(em1 + 1)/(em1*t[i] + 1);
+    }
 }
 
-double World::unifMutation(double t)
+void World::unifMutation(double* t, const double* u, int n) const
 {
-    double lowerBound = t - sigmaZ;
-    double upperBound = t + sigmaZ;
+    int i = 0;
 
-    if(lowerBound < 0)
+    for(i=0; i<n; i++)
     {
-        lowerBound = 0;
-    }
+        double lowerBound = std::max(t[i] - sigmaZ, 0.0);
+        double upperBound = std::min(t[i] + sigmaZ, 1.0);
 
-    if(upperBound > 1)
-    {
-        upperBound = 1;
+        t[i] = lowerBound + (upperBound - lowerBound)*u[i];
     }
-
-    std::uniform_real_distribution<double> unif(lowerBound, upperBound);
-
-    return unif(generator);
 }
 
-int World::getFather(int patchMother, int mother)
+int World::getFather(int patchMother, int mother, RandomEngine& patchGen)
 {
     int father = 0;
 
-    std::uniform_int_distribution<int> unif(0, patches[patchMother].population.size() - 1);
+    std::uniform_int_distribution<int> unif(0, populationOf(patchMother).size() - 1);
 
     do
     {
-        father = unif(generator);
+        father = unif(patchGen);
     }
     while (father == mother); //Pas de pseudo allofécondation
 
@@ -602,31 +1098,48 @@ bool World::redefinePollination(double p)
 
 void World::calcNewRelatednesses(void)
 {
-    int i = 0, j = 0;
+    int i = 0, k = 0;
+
+    PROFILE_PHASE(profiler, 0, relatednessPhase);
 
-    /* Les apparentements sont multipliés par 1 - mu pour introduire le fait
-       qu'une partie du génome change à cause des mutations. */
-    for(i=0; i<int(globalPop.size()); i++)
+    /* La nouvelle génération est ajoutée à la généalogie, avec les f qu'elle a reçus à sa naissance. */
+    if(kinshipMode == pedigreeKinship)
     {
-        for(j=0; j<=i; j++)
+        pedigree.push(mothers, fathers);
+
+        for(i=0; i<NPatch; i++)
         {
-            /* Il faut remplir la diagonale pour les indivdus ayant un ou deux parents en commun. */
-            if(i == j)
-            {
-                /* On a besoin du taux de consanguinité de l'individu. */
-                relatedness[(genCount+1)%2][i][j] = (1 - mitigateRelatedness) *
-                (0.5 + 0.5*patches[globalPop[i].patch].population[globalPop[i].posInPatch].f);
-            }
+            const Population& pop = populationOf(i);
 
-            else
+            for(k=0; k<patches[i].K; k++)
             {
-                relatedness[(genCount+1)%2][i][j] = (1 - mitigateRelatedness) *
-                (relatedness[genCount%2][std::max(mothers[i], mothers[j])][std::min(mothers[i], mothers[j])] +
-                 relatedness[genCount%2][std::max(fathers[i], fathers[j])][std::min(fathers[i], fathers[j])] +
-                 relatedness[genCount%2][std::max(fathers[i], mothers[j])][std::min(fathers[i], mothers[j])] +
-                 relatedness[genCount%2][std::max(mothers[i], fathers[j])][std::min(mothers[i], fathers[j])])*0.25;
+                pedigree.setInbreeding(firstOfPatch[i] + k, pop.f[k]);
             }
         }
+
+        pedigree.updateBackground(generator, kinshipSamples);
+    }
+
+    else if(relatednessBand < 0)
+    {
+        updateRelatednesses(relatedness, nextRelatedness);
+
+        /* La nouvelle matrice devient celle des parents de la génération suivante. */
+        relatedness.swap(nextRelatedness);
+    }
+    else
+    {
+        updateRelatednesses(bandedRelatedness, nextBandedRelatedness);
+
+        /* La valeur de fond doit être calculée avec les apparentements des parents. */
+        relatedness_t background = 0;
+        if(bandBackground == meanBackground)
+        {
+            background = meanBeyondBand();
+        }
+
+        nextBandedRelatedness.setBackground(background);
+        bandedRelatedness.swap(nextBandedRelatedness);
     }
 
     /* On vide les vecteurs. */
@@ -634,78 +1147,384 @@ void World::calcNewRelatednesses(void)
     mothers.clear();
 }
 
-void World::clear_and_freeVector(std::vector<double>& toClear)
-{
-    toClear.clear();
-    std::vector<double>().swap(toClear);
-}
-
-void World::printProgress(int progress)
+template <typename Matrix>
+void World::updateRelatednesses(const Matrix& parents, Matrix& offspring)
 {
     int i = 0;
-    std::cout << "[";
-    for (i=0; i<78; i++)
+    int n = firstOfPatch.back();
+
+    /* Le nombre de colonnes traitées d'un coup pour toutes les lignes d'une tuile. */
+    const int block = 2048;
+
+    if(n == 0)
     {
-        if(i<progress) {std::cout << "#";}
-        else {std::cout << ".";}
+        return;
     }
-    std::cout << "]" << std::endl;
-}
 
-void World::writeHeaders(int Kdistr, int Kmin, int Kmax, int sigmaK, int Ktot,
-                         int Pdistr, double Pmin, double Pmax, double sigmaP, double Ptot)
-{
-    report << "Nombre de patchs=" << NPatch << std::endl;
-    report << "Gestion de l'apparentement:" << relatednessIsManaged;
-    report << " Correction apparentement=" << mitigateRelatedness << std::endl;
-    report << "Delta=" << delta << " c=" << c << std::endl;
-    report << "Loi pour la mutation:" << typeMut << " mu=" << mu << " sigmaZ=" << sigmaZ;
-    report << " Taux de mutationt relatif d/s=" << d_s_relativeMutation << std::endl;
-    report << "KDistr:" << Kdistr << " Kmin=" << Kmin << " Kmax=" << Kmax << " SigmaK=" << sigmaK << " K_tot=" << Ktot << std::endl;
-    report << "PDistr:" << Pdistr << " Pmin=" << Pmin << " Pmax=" << Pmax << " SigmaP=" << sigmaP << " P_tot=" << Ptot << std::endl;
-    report << "Vérifier convergence:" << convergenceToBeChecked << " N patchs à converger=" << NPatchToConverge;
-    report << " N gen à converger=" << NGenToConverge << " Relatif=" << relativeConvergence << " Absolu=" << absoluteConvergence;
-    report << " Fréquence=" << checkConvergenceFrequency << std::endl;
-    report << "Shift=" << rangeToBeShifted << " Fréquence=" << shiftFrequency << std::endl;
-    report << "Gen\tPatch\tInd\ts\td" << std::endl;
+    /* Découpage des lignes en tuiles de même surface :
+    les lignes du bas du triangle sont plus longues que celles du haut. */
+    int nTiles = std::min(n, 4*pool.size());
+    double total = 0, area = 0;
 
-    if(logPoll_is_to_be_written)
+    for(i=0; i<n; i++)
     {
-        logPoll << "Gen" << '\t' << "Patch" << '\t' << "Etat" << std::endl;
+        total += i - offspring.firstColumn(i) + 1;
     }
-}
 
-void World::writeReport(void)
+    relatednessTiles.assign(1, 0);
+    for(i=0; i<n - 1; i++)
+    {
+        area += i - offspring.firstColumn(i) + 1;
+
+        if(area*nTiles >= total*int(relatednessTiles.size()))
+        {
+            relatednessTiles.push_back(i + 1);
+        }
+    }
+    relatednessTiles.push_back(n);
+
+    pool.parallelFor(relatednessTiles.size() - 1, [&](int tile, int worker)
+    {
+        int rowBegin = relatednessTiles[tile];
+        int rowEnd = relatednessTiles[tile + 1];
+
+        std::vector<int>& rows = scratch[worker].rows;
+
+        /* Les frères et soeurs utilisent les mêmes lignes de la matrice des parents :
+        on les traite à la suite. L'ordre n'a aucune influence sur le résultat. */
+        rows.clear();
+        for(int r=rowBegin; r<rowEnd; r++)
+        {
+            rows.push_back(r);
+        }
+        std::sort(rows.begin(), rows.end(), [this](int a, int b)
+        {
+            return mothers[a] < mothers[b] || (mothers[a] == mothers[b] && fathers[a] < fathers[b]);
+        });
+
+        /* Les apparentements sont multipliés par 1 - mu pour introduire le fait
+        qu'une partie du génome change à cause des mutations.
+        Seules les colonnes stockées de chaque ligne sont calculées. */
+        for(int colBegin=offspring.firstColumn(rowBegin); colBegin<rowEnd - 1; colBegin+=block)
+        {
+            int colEnd = colBegin + block;
+
+            for(int row : rows)
+            {
+                int first = offspring.firstColumn(row);
+                int lo = std::max(first, colBegin);
+                int hi = std::min(row, colEnd);
+                int m = hi - lo;
+
+                if(m <= 0)
+                {
+                    continue;
+                }
+
+                parents.sumParents(mothers[row], fathers[row], mothers.data() + lo, fathers.data() + lo, m,
+                                   1 - mitigateRelatedness, offspring.row(row) + (lo - first));
+            }
+        }
+
+        /* Il faut remplir la diagonale pour les indivdus ayant un ou deux parents en commun.
+        On a besoin du taux de consanguinité de l'individu : les lignes de la tuile se suivent,
+        on avance donc dans les patchs en même temps que dans les lignes. */
+        int p = std::upper_bound(firstOfPatch.begin(), firstOfPatch.end(), rowBegin) - firstOfPatch.begin() - 1;
+
+        for(int row=rowBegin; row<rowEnd; row++)
+        {
+            while(row >= firstOfPatch[p + 1])
+            {
+                p++;
+            }
+
+            offspring.row(row)[row - offspring.firstColumn(row)] = (1 - mitigateRelatedness) *
+            (0.5 + 0.5*populationOf(p).f[row - firstOfPatch[p]]);
+        }
+    });
+}
+
+relatedness_t World::meanBeyondBand(void)
 {
-    int i = 0, j = 0;
+    int p = 0, i = 0, j = 0;
+    double sum = 0, count = 0;
 
+    /* Les paires à band + 1 patchs l'une de l'autre sont les plus apparentées
+       des paires hors de la bande : leur moyenne sert pour toutes. */
+    for(p=relatednessBand + 1; p<NPatch; p++)
+    {
+        int q = p - relatednessBand - 1;
 
-    for(j=0; j<NPatch; j++)
+        for(i=firstOfPatch[p]; i<firstOfPatch[p + 1]; i++)
+        {
+            for(j=firstOfPatch[q]; j<firstOfPatch[q + 1]; j++)
+            {
+                sum += (bandedRelatedness.get(mothers[i], mothers[j]) +
+                        bandedRelatedness.get(fathers[i], fathers[j]) +
+                        bandedRelatedness.get(fathers[i], mothers[j]) +
+                        bandedRelatedness.get(mothers[i], fathers[j]))*0.25;
+                count ++;
+            }
+        }
+    }
+
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    return (1 - mitigateRelatedness)*sum/count;
+}
+
+double World::parentKinship(int i, int j, RandomEngine& patchGen) const
+{
+    if(kinshipMode == pedigreeKinship)
+    {
+        return pedigree.kinship(i, j, patchGen, kinshipSamples, kinshipError);
+    }
+
+    return getRelatedness(i, j);
+}
+
+relatedness_t World::getRelatedness(int i, int j) const
+{
+    if(relatednessBand < 0)
     {
-        for(i=0; i<patches[j].K; i++)
+        return relatedness.get(i, j);
+    }
+
+    return bandedRelatedness.get(i, j);
+}
+
+void World::printProgress(int progress)
+{
+    int i = 0;
+    std::cout << "[";
+    for (i=0; i<78; i++)
+    {
+        if(i<progress) {std::cout << "#";}
+        else {std::cout << ".";}
+    }
+    std::cout << "]" << std::endl;
+}
+
+void World::writeHeaders(int Kdistr, int Kmin, int Kmax, int sigmaK, int Ktot,
+                         int Pdistr, double Pmin, double Pmax, double sigmaP, double Ptot)
+{
+    /* L'entête est le même pour tous les formats de rapport. */
+    std::ostringstream header;
+
+    header << "Nombre de patchs=" << NPatch;
+    if(height > 1)
+    {
+        header << " Grille=" << width << "x" << height << " Voisins=" << neighbours;
+    }
+    if(kernelType != nearestKernel)
+    {
+        header << " Noyau=" << DispersalKernel::name(kernelType) << " Echelle=" << kernelScale << " Portée=" << kernelRange;
+    }
+    header << std::endl;
+    header << "Gestion de l'apparentement:" << relatednessIsManaged;
+    header << " Correction apparentement=" << mitigateRelatedness;
+    if(relatednessIsManaged && kinshipMode == pedigreeKinship)
+    {
+        header << " Généalogie=" << pedigreeDepth << " Tirages=" << kinshipSamples << " Erreur=" << kinshipError;
+    }
+    header << std::endl;
+    header << "Delta=" << delta << " c=" << c << std::endl;
+    header << "Loi pour la mutation:" << typeMut << " mu=" << mu << " sigmaZ=" << sigmaZ;
+    header << " Taux de mutationt relatif d/s=" << d_s_relativeMutation << std::endl;
+    header << "KDistr:" << Kdistr << " Kmin=" << Kmin << " Kmax=" << Kmax << " SigmaK=" << sigmaK << " K_tot=" << Ktot << std::endl;
+    header << "PDistr:" << Pdistr << " Pmin=" << Pmin << " Pmax=" << Pmax << " SigmaP=" << sigmaP << " P_tot=" << Ptot << std::endl;
+    header << "Vérifier convergence:" << convergenceToBeChecked << " N patchs à converger=" << NPatchToConverge;
+    header << " N gen à converger=" << NGenToConverge << " Relatif=" << relativeConvergence << " Absolu=" << absoluteConvergence;
+    header << " Fréquence=" << checkConvergenceFrequency << std::endl;
+    header << "Shift=" << rangeToBeShifted << " Fréquence=" << shiftFrequency << std::endl;
+    if(reportFormat == summaryReport)
+    {
+        header << "Classes=" << histogramBins << std::endl;
+        header << "Gen\tPatch\tN";
+        for(const char* trait : {"s", "d", "f"})
         {
-            report << genCount << '\t';
-            report << j << '\t';
-            report << i << '\t';
-            report << std::round(patches[j].population[i].s * 1000) / 1000 << '\t';
-            report << std::round(patches[j].population[i].d * 1000) / 1000 << std::endl;
+            header << '\t' << trait << "_moy\t" << trait << "_var\t" << trait << "_min\t" << trait << "_max\t" << trait << "_hist";
         }
+        header << std::endl;
+    }
+    else
+    {
+        header << "Gen\tPatch\tInd\ts\td" << std::endl;
     }
 
+    if(reportFormat == binaryReport)
+    {
+        binReport.writeHeader(header.str());
+    }
+    else
+    {
+        report << header.str();
+    }
 
-    if (NGen - genCount < genReport)
+    if(logPoll_is_to_be_written)
     {
-        report.close();
+        logPoll << "Gen" << '\t' << "Patch" << '\t' << "Etat" << std::endl;
     }
 }
 
+void World::writeReport(void)
+{
+    int i = 0, j = 0;
+
+    PROFILE_PHASE(profiler, 0, reportPhase);
+
+    /* On ne fait que copier les traits : le thread d'écriture s'occupe du reste. */
+    WriterSnapshot& snapshot = writer.acquire();
+
+    snapshot.kind = reportSnapshot;
+    snapshot.genCount = genCount;
+    snapshot.last = (NGen - genCount < genReport);
+    snapshot.counts.clear();
+    snapshot.s.clear();
+    snapshot.d.clear();
+
+    /* Le rapport résumé se calcule en un passage sur chaque patch : seuls les résumés sont copiés. */
+    if(reportFormat == summaryReport)
+    {
+        snapshot.summaries.resize(3*NPatch);
+
+        for(j=0; j<NPatch; j++)
+        {
+            const Population& pop = populationOf(j);
+            TraitSummary* summary = snapshot.summaries.data() + 3*j;
+
+            summary[0].reset(histogramBins);
+            summary[1].reset(histogramBins);
+            summary[2].reset(histogramBins);
+
+            for(i=0; i<patches[j].K; i++)
+            {
+                summary[0].add(pop.s[i]);
+                summary[1].add(pop.d[i]);
+                summary[2].add(pop.f[i]);
+            }
+
+            snapshot.counts.push_back(patches[j].K);
+        }
+
+        writer.publish();
+        return;
+    }
+
+    for(j=0; j<NPatch; j++)
+    {
+        const Population& pop = populationOf(j);
+
+        snapshot.counts.push_back(patches[j].K);
+        snapshot.s.insert(snapshot.s.end(), pop.s.begin(), pop.s.begin() + patches[j].K);
+        snapshot.d.insert(snapshot.d.end(), pop.d.begin(), pop.d.begin() + patches[j].K);
+    }
+
+    writer.publish();
+}
+
 void World::writeLogPoll(void)
 {
     int i = 0;
 
+    PROFILE_PHASE(profiler, 0, logPollPhase);
+
+    WriterSnapshot& snapshot = writer.acquire();
+
+    snapshot.kind = logPollSnapshot;
+    snapshot.genCount = genCount;
+    snapshot.pollenized.resize(NPatch);
+
     for(i=0; i<NPatch; i++)
     {
-        logPoll << genCount << '\t' << i << '\t' << patches[i].pollenized << std::endl;
+        snapshot.pollenized[i] = patches[i].pollenized;
+    }
+
+    writer.publish();
+}
+
+void World::writeSnapshot(const WriterSnapshot& snapshot)
+{
+    int i = 0, j = 0;
+
+    if(snapshot.kind == logPollSnapshot)
+    {
+        for(i=0; i<int(snapshot.pollenized.size()); i++)
+        {
+            logPoll << snapshot.genCount << '\t' << i << '\t' << snapshot.pollenized[i] << '\n';
+        }
+
+        return;
+    }
+
+    if(reportFormat == summaryReport)
+    {
+        for(j=0; j<int(snapshot.counts.size()); j++)
+        {
+            report << snapshot.genCount << '\t' << j << '\t' << snapshot.counts[j];
+
+            for(i=0; i<3; i++)
+            {
+                report << '\t';
+                snapshot.summaries[3*j + i].write(report);
+            }
+
+            report << '\n';
+        }
+
+        if(snapshot.last)
+        {
+            report.close();
+        }
+
+        return;
+    }
+
+    const double* s = snapshot.s.data();
+    const double* d = snapshot.d.data();
+
+    if(reportFormat == binaryReport)
+    {
+        binReport.beginGeneration(snapshot.genCount);
+
+        for(j=0; j<int(snapshot.counts.size()); j++)
+        {
+            binReport.addPatch(j, s, d, snapshot.counts[j]);
+            s += snapshot.counts[j];
+            d += snapshot.counts[j];
+        }
+
+        binReport.endGeneration();
+
+        if(snapshot.last)
+        {
+            binReport.close();
+        }
+
+        return;
+    }
+
+    for(j=0; j<int(snapshot.counts.size()); j++)
+    {
+        for(i=0; i<snapshot.counts[j]; i++)
+        {
+            report << snapshot.genCount << '\t';
+            report << j << '\t';
+            report << i << '\t';
+            report << std::round(s[i] * 1000) / 1000 << '\t';
+            report << std::round(d[i] * 1000) / 1000 << '\n';
+        }
+
+        s += snapshot.counts[j];
+        d += snapshot.counts[j];
+    }
+
+    if(snapshot.last)
+    {
+        report.close();
     }
 }
 
@@ -714,6 +1533,16 @@ void World::writeRelatednesses(void)
     int i = 0, j = 0, k = 0;
     int ind_abs_id = 0; // La position absolue de l'individu (la ligne) concerné.
 
+    if(relationFormat == binaryRelation)
+    {
+        dumpRelatednesses("relation_" + std::to_string(idWorld) + ".bin");
+        return;
+    }
+
+    PROFILE_PHASE(profiler, 0, reportPhase);
+
+    relation_report.open("relation_" + std::to_string(idWorld) + ".txt");
+
     relation_report << '\t';
 
     /* Première ligne. */
@@ -730,11 +1559,11 @@ void World::writeRelatednesses(void)
     {
         for(j=0; j<patches[i].K; j++)
         {
-            relation_report << std::endl << j << '\t';
+            relation_report << '\n' << j << '\t';
 
             for(k=0; k<=ind_abs_id; k++)
             {
-                relation_report << relatedness[0][ind_abs_id][k] << '\t';
+                relation_report << getRelatedness(ind_abs_id, k) << '\t';
             }
 
             ind_abs_id ++;
@@ -742,12 +1571,358 @@ void World::writeRelatednesses(void)
     }
 }
 
-int World::factorial(int n)
+void World::dumpRelatednesses(const std::string& path)
 {
-    if(n <= 1)
+    PROFILE_PHASE(profiler, 0, reportPhase);
+
+    if(relatednessBand < 0)
+    {
+        RelatednessDump::write(path, genCount, firstOfPatch, relatednessBand, 0, relatedness);
+    }
+    else
+    {
+        RelatednessDump::write(path, genCount, firstOfPatch, relatednessBand, bandedRelatedness.background(), bandedRelatedness);
+    }
+}
+
+std::string World::checkpointPath(void) const
+{
+    return "checkpoint_" + std::to_string(idWorld) + ".bin";
+}
+
+void World::writeCheckpoint(bool done)
+{
+    int i = 0;
+    CheckpointWriter out;
+    std::vector<std::int32_t> patchK(NPatch);
+    std::vector<double> patchP(NPatch);
+
+    PROFILE_PHASE(profiler, 0, checkpointPhase);
+
+    /* Les rapports doivent être à jour pour noter leur taille. */
+    writer.drain();
+
+    if(!out.open(checkpointPath()))
+    {
+        std::cerr << "Impossible d'écrire " << checkpointPath() << std::endl;
+        return;
+    }
+
+    /* De quoi vérifier que l'instantané correspond bien aux paramètres de la reprise. */
+    out.put<std::int32_t>(idWorld);
+    out.put<std::int32_t>(NPatch);
+    out.put<std::int32_t>(width);
+    out.put<std::int32_t>(neighbours);
+    out.put<std::int32_t>(kernelType);
+    out.put<double>(kernelScale);
+    out.put<std::int32_t>(kernelRange);
+    out.put<std::int32_t>(firstOfPatch.back());
+    out.put<std::int32_t>(NGen);
+    out.put<std::int32_t>(relatednessIsManaged);
+    out.put<std::int32_t>(relatednessBand);
+    out.put<std::int32_t>(kinshipMode);
+    out.put<std::int32_t>(kinshipMode == pedigreeKinship ? pedigreeDepth : 0);
+    out.put<std::int32_t>(reportFormat);
+    out.put<std::int32_t>(histogramBins);
+    out.put<std::int32_t>(reportPrecision);
+    out.put<std::int32_t>(reportCompression);
+    out.put<std::int32_t>(bandBackground);
+    out.put<std::int32_t>(sizeof(relatedness_t));
+    out.putString(randomEngineName());
+
+    /* Les paramètres du modèle, et le paysage qu'ils ont donné. */
+    out.put<double>(delta);
+    out.put<double>(c);
+    out.put<double>(mitigateRelatedness);
+    out.put<std::int32_t>(typeMut);
+    out.put<double>(mu);
+    out.put<double>(sigmaZ);
+    out.put<double>(d_s_relativeMutation);
+    out.put<std::int32_t>(rangeToBeShifted);
+    out.put<std::int32_t>(shiftFrequency);
+
+    for(i=0; i<NPatch; i++)
+    {
+        patchK[i] = patches[i].K;
+        patchP[i] = patches[i].p;
+    }
+
+    out.putVector(patchK);
+    out.putVector(patchP);
+
+    out.put<std::uint8_t>(done);
+
+    /* Un monde terminé ne garde que les sommes finales de ses patchs, pour en donner les moyennes. */
+    if(done)
+    {
+        for(i=0; i<NPatch; i++)
+        {
+            out.put<double>(patches[i].sumS);
+            out.put<double>(patches[i].sumD);
+        }
+    }
+
+    else
     {
-        return 1;
+        out.put<std::uint64_t>(seed);
+        out.put<std::int32_t>(genCount);
+        out.put<std::int32_t>(checkCount);
+
+        std::ostringstream state;
+        state << generator;
+        out.putString(state.str());
+
+        for(i=0; i<NPatch; i++)
+        {
+            const Patch& patch = patches[i];
+
+            const Population& pop = populationOf(i);
+
+            out.put<std::uint8_t>(patch.pollenized);
+
+            /* Les populations sont écrites dans l'ordre des patchs : l'anneau n'a pas à être sauvé. */
+            out.putVector(pop.s);
+            out.putVector(pop.d);
+            out.putVector(pop.f);
+
+            patch.dConvergence.save(out);
+            patch.sConvergence.save(out);
+        }
+
+        /* Au début d'une génération, seule la matrice des parents est utile :
+        l'autre sera entièrement réécrite, et les mères et pères sont vides. */
+        if(relatednessIsManaged)
+        {
+            if(kinshipMode == pedigreeKinship)
+            {
+                pedigree.save(out);
+            }
+            else if(relatednessBand < 0)
+            {
+                out.putBytes(relatedness.data(), relatedness.count()*sizeof(relatedness_t));
+            }
+            else
+            {
+                out.putBytes(bandedRelatedness.data(), (bandedRelatedness.count() + 1)*sizeof(relatedness_t));
+            }
+        }
+
+        /* La taille atteinte par chaque rapport (-1 : le rapport est déjà fermé). */
+        if(reportFormat == binaryReport)
+        {
+            out.put<std::int64_t>(binReport.is_open() ? std::int64_t(binReport.position()) : -1);
+            out.putVector(binReport.generations());
+            out.putVector(binReport.offsets());
+        }
+        else
+        {
+            report.flush();
+            out.put<std::int64_t>(report.is_open() ? std::int64_t(report.tellp()) : -1);
+        }
+
+        logPoll.flush();
+        out.put<std::int64_t>(logPoll.is_open() ? std::int64_t(logPoll.tellp()) : -1);
+    }
+
+    if(!out.commit())
+    {
+        std::cerr << "Impossible d'écrire " << checkpointPath() << std::endl;
+    }
+}
+
+bool World::readCheckpoint(void)
+{
+    int i = 0;
+    CheckpointReader in;
+
+    if(!in.open(checkpointPath()))
+    {
+        return false;
+    }
+
+    std::int32_t fileWorld = 0, fileNPatch = 0, fileWidth = 0, fileNeighbours = 0, fileKtot = 0, fileNGen = 0;
+    std::int32_t fileKernel = 0, fileRange = 0;
+    double fileScale = 0;
+    std::int32_t fileRelatedness = 0, fileBand = 0, fileKinship = 0, fileDepth = 0, fileFormat = 0, fileBins = 0;
+    std::int32_t fileBackground = 0, fileValueSize = 0, filePrecision = 0, fileCompression = 0;
+    std::string fileEngine;
+    double fileDelta = 0, fileC = 0, fileMitigate = 0, fileMu = 0, fileSigmaZ = 0, fileRelativeMutation = 0;
+    std::int32_t fileTypeMut = 0, fileShifted = 0, fileShiftFrequency = 0;
+    std::vector<std::int32_t> fileK;
+    std::vector<double> fileP;
+    std::uint8_t done = 0;
+
+    in.get(fileWorld);
+    in.get(fileNPatch);
+    in.get(fileWidth);
+    in.get(fileNeighbours);
+    in.get(fileKernel);
+    in.get(fileScale);
+    in.get(fileRange);
+    in.get(fileKtot);
+    in.get(fileNGen);
+    in.get(fileRelatedness);
+    in.get(fileBand);
+    in.get(fileKinship);
+    in.get(fileDepth);
+    in.get(fileFormat);
+    in.get(fileBins);
+    in.get(filePrecision);
+    in.get(fileCompression);
+    in.get(fileBackground);
+    in.get(fileValueSize);
+    in.getString(fileEngine);
+    in.get(fileDelta);
+    in.get(fileC);
+    in.get(fileMitigate);
+    in.get(fileTypeMut);
+    in.get(fileMu);
+    in.get(fileSigmaZ);
+    in.get(fileRelativeMutation);
+    in.get(fileShifted);
+    in.get(fileShiftFrequency);
+    in.getVector(fileK);
+    in.getVector(fileP);
+    in.get(done);
+
+    bool sameLandscape = int(fileK.size()) == NPatch && int(fileP.size()) == NPatch;
+
+    for(i=0; sameLandscape && i<NPatch; i++)
+    {
+        sameLandscape = fileK[i] == patches[i].K && fileP[i] == patches[i].p;
+    }
+
+    if(!in.good() || fileWorld != idWorld || fileNPatch != NPatch || fileWidth != width || fileNeighbours != neighbours ||
+       fileKernel != kernelType || fileScale != kernelScale || fileRange != kernelRange ||
+       fileKtot != firstOfPatch.back() ||
+       fileNGen != NGen || fileRelatedness != relatednessIsManaged || fileBand != relatednessBand || fileFormat != reportFormat ||
+       (relatednessIsManaged && (fileKinship != kinshipMode || (kinshipMode == pedigreeKinship && fileDepth != pedigreeDepth))) ||
+       (reportFormat == summaryReport && fileBins != histogramBins) ||
+       (reportFormat == binaryReport && (filePrecision != reportPrecision || fileCompression != reportCompression)) ||
+       (relatednessIsManaged && (relatednessBand >= 0 || kinshipMode == pedigreeKinship) && fileBackground != bandBackground) ||
+       (relatednessIsManaged && kinshipMode == exactKinship && fileValueSize != int(sizeof(relatedness_t))) ||
+       fileEngine != randomEngineName() ||
+       fileDelta != delta || fileC != c || fileMitigate != mitigateRelatedness || fileTypeMut != typeMut ||
+       fileMu != mu || fileSigmaZ != sigmaZ || fileRelativeMutation != d_s_relativeMutation ||
+       fileShifted != rangeToBeShifted || fileShiftFrequency != shiftFrequency || !sameLandscape)
+    {
+        throw std::runtime_error(checkpointPath() + " ne correspond pas aux paramètres du monde");
+    }
+
+    if(done)
+    {
+        for(i=0; i<NPatch; i++)
+        {
+            in.get(patches[i].sumS);
+            in.get(patches[i].sumD);
+        }
+
+        if(!in.good())
+        {
+            throw std::runtime_error(checkpointPath() + " est incomplet");
+        }
+
+        finished = true;
+        return true;
+    }
+
+    std::int32_t fileGen = 0, fileCheck = 0;
+    std::string state;
+
+    in.get(seed);
+    in.get(fileGen);
+    in.get(fileCheck);
+    in.getString(state);
+
+    genCount = fileGen;
+    checkCount = fileCheck;
+
+    std::istringstream stateStream(state);
+    stateStream >> generator;
+
+    for(i=0; i<NPatch; i++)
+    {
+        Patch& patch = patches[i];
+        Population& pop = populations[i];
+        std::uint8_t flag = 0;
+
+        in.get(flag);
+        patch.pollenized = flag;
+
+        in.getVector(pop.s);
+        in.getVector(pop.d);
+        in.getVector(pop.f);
+
+        patch.updateSums(pop);
+
+        patch.dConvergence.load(in);
+        patch.sConvergence.load(in);
+    }
+
+    if(relatednessIsManaged)
+    {
+        if(kinshipMode == pedigreeKinship)
+        {
+            pedigree.load(in);
+        }
+        else if(relatednessBand < 0)
+        {
+            in.getBytes(relatedness.data(), relatedness.count()*sizeof(relatedness_t));
+        }
+        else
+        {
+            in.getBytes(bandedRelatedness.data(), (bandedRelatedness.count() + 1)*sizeof(relatedness_t));
+        }
+    }
+
+    std::int64_t reportSize = 0, logPollSize = 0;
+    std::vector<int> gens;
+    std::vector<std::uint64_t> offsets;
+
+    in.get(reportSize);
+    if(reportFormat == binaryReport)
+    {
+        in.getVector(gens);
+        in.getVector(offsets);
+    }
+    in.get(logPollSize);
+
+    if(!in.good())
+    {
+        throw std::runtime_error(checkpointPath() + " est incomplet");
+    }
+
+    /* Les rapports reprennent exactement là où en était l'instantané. */
+    std::string reportPath = "report_" + std::to_string(idWorld) + (reportFormat == binaryReport ? ".bin" : ".txt");
+
+    if(reportSize >= 0)
+    {
+        if(!truncateFile(reportPath, reportSize))
+        {
+            throw std::runtime_error("impossible de reprendre " + reportPath);
+        }
+
+        if(reportFormat == binaryReport)
+        {
+            binReport.reopen(reportPath, reportPrecision, reportCompression, gens, offsets);
+        }
+        else
+        {
+            report.open(reportPath, std::ios::app);
+        }
+    }
+
+    if(logPoll_is_to_be_written && logPollSize >= 0)
+    {
+        std::string logPollPath = "logPoll_" + std::to_string(idWorld) + ".txt";
+
+        if(!truncateFile(logPollPath, logPollSize))
+        {
+            throw std::runtime_error("impossible de reprendre " + logPollPath);
+        }
+
+        logPoll.open(logPollPath, std::ios::app);
     }
 
-    return n*factorial(n - 1);
+    return true;
 }
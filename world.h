@@ -4,8 +4,21 @@
 #include <vector>
 #include <array>
 #include <fstream>
+#include <random>
+#include <cstdint>
 
 #include "patch.h"
+#include "population.h"
+#include "alias_sampler.h"
+#include "thread_pool.h"
+#include "options.h"
+#include "binary_report.h"
+#include "relatedness.h"
+#include "profile.h"
+#include "writer.h"
+#include "rng.h"
+#include "dispersal.h"
+#include "pedigree.h"
 
 
 /**
@@ -20,12 +33,39 @@ typedef enum _mut_
 } distrMut;
 
 
-/** @brief Structure qui permet de stocker la position relative (dans un patch) pour un individu. */
-typedef struct _IndividualPosition_
+/**
+ * @brief
+ * Structure qui contient les patchs d'où viennent les graines d'un patch,
+ * avec la table des alias de chacun et les sommes cumulées de leurs pressions totales.
+ *
+ * Une graine se tire en deux temps : le patch de la mère par une recherche dans
+ * les sommes cumulées, puis la propagule dans la table de ce patch.
+ * Le coût d'un tirage ne dépend donc presque pas de la portée de la dispersion.
+ */
+typedef struct _SeedSources_
 {
-    int posInPatch;
-    int patch;
-} IndividualPosition;
+    std::vector<int> patch; /**< @brief L'identifiant de chaque patch, par ordre croissant */
+    std::vector<const AliasSampler*> sampler; /**< @brief La table des alias des propagules de chaque patch */
+    std::vector<double> cumulative; /**< @brief La somme des pressions totales des patchs, jusqu'à celui-ci compris */
+    int last; /**< @brief Le dernier patch dont la pression n'est pas nulle */
+} SeedSources;
+
+/**
+ * @brief
+ * Structure qui contient les vecteurs de travail d'un thread
+ * pendant la création d'une génération.
+ */
+typedef struct _GenerationScratch_
+{
+    std::vector<double> press; /**< @brief Les pressions en propagules résidentes du patch en cours */
+    AliasSampler motherSampler; /**< @brief La table des alias qui sert à tirer les mères résidentes */
+    SeedSources sources; /**< @brief Les patchs d'où viennent les graines du patch en cours */
+    std::vector<int> rows; /**< @brief Les lignes d'une tuile de la matrice d'apparentement, triées par parents */
+    std::vector<int> sMutants; /**< @brief Les descendants du patch en cours dont s mute */
+    std::vector<int> dMutants; /**< @brief Les descendants du patch en cours dont d mute */
+    std::vector<double> mutantValues; /**< @brief Les traits qui mutent, rassemblés */
+    std::vector<double> mutantNoise; /**< @brief Le tirage de chaque mutation */
+} GenerationScratch;
 
 /**
  * @brief
@@ -53,37 +93,188 @@ public:
      * @param sigmaP    Le degré de varition de P dans l'espace.
      * @param sInit     Le taux d'autofécondation initial.
      * @param dInit     Le taux de dispersion initial.
+     * @param options   Les réglages facultatifs (nombre de threads...).
      */
     World(int idWorld, int NPatch, double delta, double c, bool relatednessIsManaged, double mitigateRelatedness,
           bool rangeToBeShifted, int shiftFrequency,
           int typeMut, double mu, double sigmaZ, double d_s_relativeMutation, int Kdistr, int Kmin, int Kmax, int sigmaK,
           int Pdistr, double Pmin, double Pmax, double sigmaP, double sInit, double dInit,
           bool convergenceToBeChecked, int NPatchToConverge, int NGenToConverge, double relativeConvergence,
-          double absoluteConvergence, int checkConvergenceFrequency, int NGen, int genReport, bool logPoll_is_to_be_written);
+          double absoluteConvergence, int checkConvergenceFrequency, int NGen, int genReport, bool logPoll_is_to_be_written,
+          const Options& options = Options());
 
     /**
      * @brief
-     * Méthode qui lance la simulation
+     * Méthode qui lance la simulation (ou la poursuit, après une reprise)
      *
      * @param idWorld   Permet d'identifier le monde sur l'écran de progression
+     *
+     * @return          Vrai si la simulation est allée à son terme,
+     *                  faux si elle a été arrêtée par un signal (l'instantané est alors écrit)
+     */
+    bool run(int idWorld);
+
+    /**
+     * @brief
+     * Méthode qui renvoie la moyenne de s et de d dans chaque patch, pour la génération en cours.
+     * Après run, ce sont les moyennes finales (dernière génération ou convergence),
+     * même pour un monde repris qui avait déjà terminé.
+     *
+     * @param meanS     Reçoit la moyenne de s de chaque patch
+     * @param meanD     Reçoit la moyenne de d de chaque patch
+     */
+    void patchMeans(std::vector<double>& meanS, std::vector<double>& meanD) const;
+
+    /**
+     * @brief
+     * Méthode qui calcule la capacité d'accueil de chaque patch.
+     *
+     * Sur une grille, la distribution normale est centrée au milieu de la grille
+     * et les distributions linéaires varient d'une colonne à l'autre.
+     *
+     * @param NPatch    Le nombre de patchs
+     * @param width     Le nombre de colonnes de la grille (0 = chaîne)
+     * @param Kdistr    Le type de distribution de K (0=normale; 1 et 2=linéaires gauche>droite ou droite>gauche).
+     * @param Kmin      La capacité d'accueil minimale.
+     * @param Kmax      La capacité d'accueil maximale.
+     * @param sigmaK    Le degré de varition de K dans l'espace.
+     *
+     * @return          La valeur de K pour chaque patch
+     */
+    static std::vector<int> buildK(int NPatch, int width, int Kdistr, int Kmin, int Kmax, int sigmaK);
+
+    /**
+     * @brief
+     * Méthode qui calcule la probabilité de pollinisation de chaque patch.
+     *
+     * @param NPatch    Le nombre de patchs
+     * @param width     Le nombre de colonnes de la grille (0 = chaîne)
+     * @param Pdistr    Le type de distribution de P (0=normale; 1 et 2=linéaires gauche>droite ou droite>gauche).
+     * @param Pmin      La probabilité minimale qu'un patch soit pollinisé.
+     * @param Pmax      La probabilité maximale qu'un patch soit pollinisé.
+     * @param sigmaP    Le degré de varition de P dans l'espace.
+     *
+     * @return          La valeur de P pour chaque patch
+     */
+    static std::vector<double> buildP(int NPatch, int width, int Pdistr, double Pmin, double Pmax, double sigmaP);
+
+    /**
+     * @brief
+     * Méthode qui permet de retourner une valeur pour un patch selon sa distance
+     * au milieu de la grille (distribution normale).
+     *
+     * @param columns   Le nombre de colonnes de patchs
+     * @param rows      Le nombre de lignes de patchs (1 pour une chaîne)
+     * @param minVal    Valeur maximale
+     * @param maxVal    Valeur minimale
+     * @param sigma     Degré de variation
+     * @param posPatch  L'identifiant du patch (colonne·rows + ligne)
+     *
+     * @return          La valeur pour le patch donné
+     */
+    static double GaussDistr(int columns, int rows, double minVal, double maxVal, double sigma, int posPatch);
+
+    /**
+     * @brief
+     * Méthode qui estime la mémoire occupée par un monde.
+     *
+     * Les matrices d'apparentement, en Ktot² (ou en NPatch·K² en bande), dominent dès que l'apparentement est géré.
+     *
+     * Avec kinship=pedigree, c'est la généalogie, en profondeur·Ktot.
+     *
+     * @param K                     La capacité d'accueil de chaque patch
+     * @param relatednessIsManaged  Si l'apparentement est géré
+     * @param options               Les réglages facultatifs (band=, kinship=, depth=)
+     *
+     * @return                      La mémoire estimée, en octets
      */
-    void run(int idWorld);
+    static double predictMemory(const std::vector<int>& K, bool relatednessIsManaged, const Options& options);
+
+    /**
+     * @brief
+     * Méthode qui donne, pour chaque patch, les patchs d'où viennent ses graines : lui-même (part 1)
+     * et ceux à portée du noyau de dispersion (avec la part de leurs graines dispersantes qui arrive),
+     * par ordre croissant d'identifiant. Les graines qui partent hors du monde sont perdues.
+     *
+     * @param columns       Le nombre de colonnes de patchs
+     * @param rows          Le nombre de lignes de patchs (1 pour une chaîne)
+     * @param kernel        Le noyau de dispersion
+     * @param sources       Reçoit les patchs sources, patch par patch
+     * @param shares        Reçoit la part de chaque source
+     * @param firstSource   Reçoit la position des sources de chaque patch dans sources, plus sa taille à la fin
+     */
+    static void buildSeedSources(int columns, int rows, const DispersalKernel& kernel, std::vector<int>& sources,
+                                 std::vector<double>& shares, std::vector<int>& firstSource);
 
 private:
 
+    /** @brief Le banc d'essai (bench/) mesure séparément les étapes d'une génération. */
+    friend class WorldBench;
+
+    int idWorld; /**< @brief L'identifiant du monde, qui nomme ses fichiers */
+
     int NPatch; /**< @brief Nombre de patchs du monde */
 
+    /**
+     * @brief Le nombre de colonnes de patchs.
+     *
+     * Les patchs sont rangés colonne par colonne : le patch (x, y) est le patch x·height + y.
+     * Une chaîne est une grille d'une seule ligne.
+     */
+    int width;
+
+    int height; /**< @brief Le nombre de lignes de patchs (1 pour une chaîne) */
+
+    int neighbours; /**< @brief Le nombre de voisins de chaque patch sur une grille (4 ou 8) */
+
+    dispersalKernel kernelType; /**< @brief La forme du noyau de dispersion */
+    double kernelScale; /**< @brief L'échelle du noyau de dispersion, en patchs */
+    int kernelRange; /**< @brief La distance maximale de dispersion, en patchs */
+
+    /**
+     * @brief Les patchs d'où viennent les graines de chaque patch : ceux à portée et lui-même, par ordre croissant.
+     *
+     * Ceux du patch i sont seedSources[firstSeedSource[i]] à seedSources[firstSeedSource[i + 1] - 1].
+     */
+    std::vector<int> seedSources;
+
+    /**
+     * @brief La part des graines dispersantes de chaque patch source qui arrive dans le patch (voir DispersalKernel).
+     * Elle vaut 1 pour le patch lui-même, dont ce sont les graines résidentes.
+     */
+    std::vector<double> seedShares;
+
+    /** @brief La position du premier patch source de chaque patch dans seedSources, plus sa taille à la fin */
+    std::vector<int> firstSeedSource;
+
     std::vector<Patch> patches; /**< @brief Vecteur qui contient tous les patchs du monde */
 
     /**
-     * @brief Vecteur qui contient, pour chaque individu, le numéro de son patch et sa postion dans celui-ci.
+     * @brief Les individus de chaque patch, rangés en anneau.
      *
-     * Ce vecteur permet de connaitre la position relative (dans un patch) d'un individu
-     * à partir de sa posititon absolue (dans le monde).
-     * Ce vecteur est très utile pour récupérer les infos de la mère après l'avoir tirée au sort.
-     * Il sert également pour gérer l'apparentement entre individus.
+     * La population du patch i est populations[(i + ringOffset)%NPatch] (voir populationOf).
+     * Un shift fait passer chaque population au patch de gauche sans la copier :
+     * il suffit d'avancer ringOffset d'une colonne (height patchs).
      */
-    std::vector<IndividualPosition> globalPop;
+    std::vector<Population> populations;
+
+    int ringOffset; /**< @brief Le nombre de patchs dont l'anneau a tourné, modulo NPatch */
+
+    /**
+     * @brief
+     * Le décalage (en patchs) entre le patch d'un parent et celui de sa ligne dans la matrice d'apparentement.
+     * Il vaut height pendant la génération qui suit un shift : les parents ont changé de patch, pas leurs apparentements.
+     */
+    int parentShift;
+
+    /**
+     * @brief La position absolue du premier individu de chaque patch, plus Ktot à la fin.
+     *
+     * Ce sont les pos_of_first_ind des patchs : elles ne dépendent que des K.
+     * Elles suffisent pour passer de la position absolue d'un individu (sa ligne dans
+     * la matrice d'apparentement) à son patch et à sa position dans celui-ci.
+     */
+    std::vector<int> firstOfPatch;
 
     double delta; /**< @brief La dépression de consanguinité */
     double c; /**< @brief Le coût de dispersion */
@@ -102,7 +293,6 @@ private:
     bool convergenceToBeChecked; /**< @brief Indique si on doit vérifier l'état de convergence */
     int NPatchToConverge; /**< @brief Le nombre de patchs qui doivent converger pour que le monde ait convergé */
     int NGenToConverge; /**< @brief Le nbr de vérifications de convergence consécutives identiques pour que le patch ait convergé */
-    int n_choose_2; /**< @brief Le nombre de combinaisons de 2 parmi les générations à vérifier pour la convergence */
     double relativeConvergence; /**< @brief Le critère de variation relative pour juger de l'état de convergence */
     double absoluteConvergence; /**< @brief Le critère de variation absoule pour juger de l'état de convergence */
     int checkConvergenceFrequency; /**< @brief La fréquence à laquelle l'état de convergence doit être vérifié */
@@ -110,28 +300,86 @@ private:
     int NGen; /**< @brief Le nombre de générations à créer */
     int genReport; /**< @brief Le nombre de générations entre chaque rapport .txt */
     int genCount; /**< @brief Compteur de générations */
+    int checkCount; /**< @brief Le nombre de vérifications de convergence déjà faites */
+
+    int checkpointFrequency; /**< @brief Le nombre de générations entre deux instantanés (0 = aucun) */
+    bool finished; /**< @brief Si le monde repris avait déjà terminé sa simulation */
 
     bool logPoll_is_to_be_written; /**< @brief Si le log des états de pollinisation doit être écrit. */
 
-    std::mt19937_64 generator; /**< @brief Générateur de nombre aléatoire */
+    bool showProgress; /**< @brief Si la progression doit être affichée à l'écran. */
+
+    Profiler profiler; /**< @brief Le temps passé dans chaque étape (vide sans -DPLANTS_PROFILE) */
+    int profileFrequency; /**< @brief Le nombre de générations entre deux lignes de la série du profil */
+
+    RandomEngine generator; /**< @brief Générateur de nombre aléatoire (pollinisation) */
 
+    std::uint64_t seed; /**< @brief La graine dont dérivent tous les flux aléatoires du monde */
+
+    ThreadPool pool; /**< @brief Les threads qui créent les générations */
+
+    /**
+     * @brief L'ordre dans lequel les patchs sont distribués aux threads.
+     *
+     * Sur une chaîne, les patchs sont triés par K décroissant : les plus coûteux sont
+     * distribués en premier, ce qui équilibre la charge quand K varie dans l'espace.
+     * Sur une grille, ils sont parcourus par carrés de patchs voisins (voir latticeTile),
+     * pour que les tables des alias des voisins restent en cache.
+     */
+    std::vector<int> patchOrder;
 
     /**
-     * @brief Deux vecteurs qui contiennent temporairement la nouvelle génération d'un patch
+     * @brief Vecteur qui contient temporairement la nouvelle génération de chaque patch
      *
      * Pour plus de détails, voir la méthode createNextGen
      */
-    std::array<std::vector<Individual>,2> juveniles;
+    std::vector<Population> juveniles;
+
+    /** @brief Les mères choisies pour la nouvelle génération de chaque patch */
+    std::vector<std::vector<int>> patchMothers;
+
+    /** @brief Les pères choisis pour la nouvelle génération de chaque patch */
+    std::vector<std::vector<int>> patchFathers;
+
+    /** @brief Les vecteurs de travail de chaque thread */
+    std::vector<GenerationScratch> scratch;
 
     /**
      * @brief
-     * Vecteur de vecteurs (demi-matrice) qui contient
-     * tous les apparentements entre tous les individus.
-     *
-     * Pour les générations paires, les parents sont dans la case 0.
-     * Pour les générations impaires, les parents sont dans la case 1.
+     * Demi-matrice qui contient tous les apparentements
+     * entre tous les individus de la génération en cours (les parents).
      */
-    std::array<std::vector<std::vector<double>>, 2> relatedness;
+    RelatednessMatrix relatedness;
+
+    /**
+     * @brief
+     * Demi-matrice qui reçoit les apparentements de la nouvelle génération.
+     * Elle est échangée avec relatedness à la fin de calcNewRelatednesses.
+     */
+    RelatednessMatrix nextRelatedness;
+
+    /** @brief La distance (en patchs) des paires suivies, -1 si toutes les paires sont suivies. */
+    int relatednessBand;
+
+    /** @brief L'apparentement des paires hors de la bande */
+    backgroundBand bandBackground;
+
+    modeKinship kinshipMode; /**< @brief Comment les apparentements sont obtenus */
+    int pedigreeDepth; /**< @brief Le nombre de générations gardées dans la généalogie */
+    int kinshipSamples; /**< @brief Le nombre maximal de paires de lignées par apparentement estimé */
+    double kinshipError; /**< @brief L'erreur type visée pour un apparentement estimé */
+
+    /** @brief La généalogie des dernières générations, avec kinship=pedigree */
+    Pedigree pedigree;
+
+    /** @brief Les apparentements des parents quand seules les paires proches sont suivies */
+    BandedRelatednessMatrix bandedRelatedness;
+
+    /** @brief Les apparentements de la nouvelle génération quand seules les paires proches sont suivies */
+    BandedRelatednessMatrix nextBandedRelatedness;
+
+    /** @brief La première ligne de chaque tuile de la matrice d'apparentement (plus le nombre de lignes à la fin) */
+    std::vector<int> relatednessTiles;
 
     /**
      * @brief
@@ -148,77 +396,188 @@ private:
     std::vector<int> mothers;
 
     std::ofstream logPoll; /**< @brief Variable permettant d'écrire le journal de la pollinisation */
+    formatReport reportFormat; /**< @brief Le format du rapport */
+    int histogramBins; /**< @brief Le nombre de classes des histogrammes du rapport résumé */
+    precisionReport reportPrecision; /**< @brief Le stockage des traits dans le rapport binaire */
+    bool reportCompression; /**< @brief Si les colonnes du rapport binaire sont compressées */
     std::ofstream report; /**< @brief Variable permettant d'écrire le rapport */
+    BinaryReport binReport; /**< @brief Variable permettant d'écrire le rapport au format binaire */
     std::ofstream relation_report; /**< @brief Variable permettant d'écrire tous les apperentements */
+    formatRelation relationFormat; /**< @brief Le format de la matrice d'apparentement finale */
+    int dumpFrequency; /**< @brief Toutes les combien de générations la matrice d'apparentement est écrite en binaire (0 = jamais) */
+
+    /** @brief Le côté (en patchs) des carrés dans lesquels une grille est parcourue */
+    static const int latticeTile = 8;
+
+    /** @brief Le nombre d'instantanés qui peuvent attendre le thread d'écriture */
+    static const int writerCapacity = 8;
+
+    /**
+     * @brief Le thread qui écrit le rapport et le journal de pollinisation.
+     *
+     * Il est déclaré après les fichiers : il est donc détruit (et termine ses écritures) avant eux.
+     */
+    AsyncWriter writer;
 
     /**
      * @brief
-     * Méthode qui permet de retourner une valeur pour un patch selon sa position (distribution normale).
+     * Renvoie les individus d'un patch.
      *
-     * @param minVal    Valeur maximale
-     * @param maxVal    Valeur minimale
-     * @param sigma     Degré de variation
-     * @param i         La position du patch
+     * @param idPatch   L'identifiant du patch
+     */
+    Population& populationOf(int idPatch)
+    {
+        return populations[(idPatch + ringOffset)%NPatch];
+    }
+
+    const Population& populationOf(int idPatch) const
+    {
+        return populations[(idPatch + ringOffset)%NPatch];
+    }
+
+    /**
+     * @brief
+     * Renvoie la ligne d'un parent dans la matrice d'apparentement.
      *
-     * @return          La valeur pour le patch donné
+     * @param idPatch       Le patch du parent
+     * @param posInPatch    La position du parent dans son patch
      */
-     double GaussDistr(double minVal, double maxVal, double sigma, int posPatch);
+    int parentRow(int idPatch, int posInPatch) const
+    {
+        return patches[idPatch + parentShift].pos_of_first_ind + posInPatch;
+    }
+
+    /**
+     * @brief
+     * Méthode qui déplace l'aire de répartition d'une colonne de patchs vers la gauche.
+     *
+     * Chaque population passe au patch de gauche, dont elle garde les K premiers individus,
+     * les populations de la colonne la plus à gauche disparaissent et la colonne de droite est vidée.
+     * Le paysage (K, p) ne bouge pas : seul l'anneau des populations tourne,
+     * sans aucune copie d'individu.
+     */
+    void shiftRange(void);
+
+    /**
+     * @brief
+     * Méthode qui crée la nouvelle génération de tous les patchs.
+     *
+     * Les pressions dispersantes de chaque patch et leur table des alias sont d'abord calculées
+     * une seule fois pour tous ses voisins, puis chaque patch crée sa nouvelle génération
+     * à partir de son propre flux aléatoire (éventuellement en parallèle).
+     * Les anciennes générations ne sont remplacées qu'à la fin,
+     * le résultat ne dépend donc ni de l'ordre ni du nombre de threads.
+     */
+    void createNextGeneration(void);
 
     /**
      * @brief
      * Méthode qui crée la nouvelle génération d'un patch en argument
      *
-     * Afin d'éviter de garder en mémoire des données inutiles
-     * c'est seulement à cette étape que sont calculées les pressions
-     * en propagules. De plus, on ne calcule que les pressions utiles
-     * pour la création de la nouvelle génération de ce patch.
-     * La nouvelle génération est stockée temporairement puis elle
-     * remplace l'ancienne dès que cette dernière n'est plus utile
-     * pour les calculs (i.e. quand on a créé la génération à gauche
-     * du patch, puisqu'on progresse de gauche à droite).
+     * Les tables des alias utiles pour ce patch sont rassemblées
+     * (dispersantes des voisins et résidentes du patch local), puis
+     * la nouvelle génération est stockée dans juveniles[idPatch].
      *
      * @param idPatch   L'identifiant du patch dont on souhaite créer la nouvelle génération.
+     * @param worker    Le numéro du thread qui crée la génération.
+     */
+    void createNextGen(int idPatch, int worker);
+
+    /**
+     * @brief
+     * Méthode qui rassemble les patchs d'où viennent les graines d'un patch.
+     *
+     * Seule la table des propagules résidentes est construite ici (dans les vecteurs du thread) :
+     * celles des patchs à portée ont été construites par updateDispSeeds.
+     *
+     * @param idPatch   L'identifiant du patch
+     * @param worker    Le numéro du thread
+     */
+    void gatherSeedSources(int idPatch, int worker);
+
+    /**
+     * @brief
+     * Méthode qui tire une propagule parmi celles rassemblées par gatherSeedSources.
+     *
+     * @param sources       Les patchs d'où viennent les graines
+     * @param patchGen      Le flux aléatoire du patch
+     * @param patchMother   Reçoit le patch de la mère
+     *
+     * @return              La propagule tirée dans ce patch (la mère est la propagule/2, paire si autof)
      */
-    void createNextGen(int idPatch);
+    int sampleSeed(const SeedSources& sources, RandomEngine& patchGen, int& patchMother) const;
+
+    /**
+     * @brief
+     * Méthode qui renvoie le flux aléatoire d'un patch
+     * pour la génération en cours, dérivé de la graine du monde.
+     *
+     * @param idPatch   L'identifiant du patch
+     *
+     * @return          Le générateur, au début du flux
+     */
+    RandomEngine patchStream(int idPatch);
 
     /**
      * @brief
      * Méthode qui crée un nouvel individu selon la propagule choisie
      *
-     * @param whr           indique dans quel vecteur temporaire il faut stocker la génération.
-     * @param mother        identifiant globale de la mère
+     * @param idPatch       le patch dont on crée la nouvelle génération
+     * @param patchMother   le patch de la mère
+     * @param mother        la position de la mère dans son patch
      * @param autof         si la graine est issue d'autof ou non
+     * @param patchGen      le flux aléatoire du patch
+     */
+    void newInd(int idPatch, int patchMother, int mother, bool autof, RandomEngine& patchGen);
+
+    /**
+     * @brief
+     * Méthode qui applique les mutations à toute une nouvelle génération.
+     *
+     * Seuls les mutants sont tirés, par sauts géométriques d'un mutant au suivant :
+     * le nombre de tirages est proportionnel à mu·K et non plus à K.
+     * Chaque mutant a un seul de ses traits qui mute (d avec la probabilité d_s_relativeMutation).
+     *
+     * @param pop           La population à muter
+     * @param worker        Le numéro du thread (pour ses vecteurs de travail)
+     * @param patchGen      Le flux aléatoire du patch
+     * @param sumS          La somme des s de la population, corrigée des mutations
+     * @param sumD          La somme des d de la population, corrigée des mutations
      */
-    void newInd(int whr, int mother, bool autof);
+    void mutation(Population& pop, int worker, RandomEngine& patchGen, double& sumS, double& sumD);
 
     /**
      * @brief
-     * Méthode qui applique une mutation aléatoire
-     * sur un des traits de l'individu
+     * Méthode qui fait muter un même trait chez plusieurs individus :
+     * les ampleurs sont tirées d'abord, puis appliquées à tous d'un coup.
      *
-     * @param IndToMutate   L'individu à muter
+     * @param traits        Les valeurs du trait dans la population
+     * @param mutants       Les positions des individus dont ce trait mute
+     * @param worker        Le numéro du thread (pour ses vecteurs de travail)
+     * @param patchGen      Le flux aléatoire du patch
+     * @param sum           La somme du trait dans la population, corrigée des mutations
      */
-    void mutation(Individual& IndToMutate);
+    void mutateTraits(double* traits, const std::vector<int>& mutants, int worker, RandomEngine& patchGen, double& sum);
 
     /**
       * @brief
-      * Crée une mutation selon une loi uniforme.
-      *
-      * @param t        Valeur du trait à muter.
+      * Crée des mutations selon une loi uniforme, entre t - sigmaZ et t + sigmaZ (bornés par 0 et 1).
       *
-      * @return         La valeur du trait après mutation.
+      * @param t        Les valeurs des traits à muter, remplacées par leur valeur après mutation.
+      * @param u        Un tirage uniforme entre 0 et 1 pour chaque trait
+      * @param n        Le nombre de traits
       */
-    double unifMutation(double t);
+    void unifMutation(double* t, const double* u, int n) const;
 
     /**
       * @brief
-      * Crée une mutation selon une loi normale.
+      * Crée des mutations selon une loi normale, sur l'échelle logistique du trait.
       *
-      * @param t        Valeur du trait à muter.
-      *
-      * @return         La valeur du trait après mutation.
+      * @param t        Les valeurs des traits à muter, remplacées par leur valeur après mutation.
+      * @param deltaMu  L'ampleur de chaque mutation, tirée selon une loi normale (0, sigmaZ)
+      * @param n        Le nombre de traits
       */
-    double gaussMutation(double t);
+    void gaussMutation(double* t, const double* deltaMu, int n) const;
 
     /**
      * @brief
@@ -231,10 +590,11 @@ private:
      *
      * @param idPatch       patch de la mère
      * @param mother        identifiant de la mère
+     * @param patchGen      le flux aléatoire du patch
      *
      * @return              L'identifiant du père
      */
-    int getFather(int patchMother, int mother);
+    int getFather(int patchMother, int mother, RandomEngine& patchGen);
 
     /**
      * @brief
@@ -250,6 +610,51 @@ private:
     /** @brief Méthode qui va recalculer les apparentements entre tous les individus. */
     void calcNewRelatednesses(void);
 
+    /**
+     * @brief
+     * Méthode qui calcule les apparentements de la nouvelle génération
+     * à partir de ceux des parents, pour les paires stockées dans la matrice.
+     *
+     * Le même calcul sert à la demi-matrice complète et à la matrice en bande.
+     * Les lignes sont découpées en tuiles de même surface réparties entre les threads.
+     * Dans une tuile, les colonnes sont parcourues par blocs et les lignes sont
+     * triées par parents, pour que les apparentements lus restent en cache.
+     *
+     * @param parents       Les apparentements des parents
+     * @param offspring     Les apparentements de la nouvelle génération
+     */
+    template <typename Matrix>
+    void updateRelatednesses(const Matrix& parents, Matrix& offspring);
+
+    /**
+     * @brief
+     * Méthode qui calcule l'apparentement moyen de la nouvelle génération
+     * entre les patchs situés juste au-delà de la bande.
+     *
+     * @return      La nouvelle valeur de fond
+     */
+    relatedness_t meanBeyondBand(void);
+
+    /**
+     * @brief
+     * Renvoie l'apparentement entre deux parents, quel que soit le stockage.
+     *
+     * @param i     La position absolue du premier individu
+     * @param j     La position absolue du second individu
+     */
+    relatedness_t getRelatedness(int i, int j) const;
+
+    /**
+     * @brief
+     * Renvoie l'apparentement entre deux parents : lu dans la matrice,
+     * ou estimé dans la généalogie avec kinship=pedigree.
+     *
+     * @param i             La position absolue du premier individu
+     * @param j             La position absolue du second individu
+     * @param patchGen      Le générateur du patch, pour l'estimation
+     */
+    double parentKinship(int i, int j, RandomEngine& patchGen) const;
+
     /**
      * @brief
      * Méthode qui affiche la progression à l'écran du terminal.
@@ -274,31 +679,67 @@ private:
     void writeHeaders(int Kdistr, int Kmin, int Kmax, int sigmaK, int Ktot,
                       int Pdistr, double Pmin, double Pmax, double sigmaP, double Ptot);
 
-    /** @brief Méthode qui écrit un rapport pour un génération donnée */
+    /** @brief Méthode qui copie les traits de la génération pour le rapport (écrit par le thread d'écriture) */
     void writeReport(void);
 
-    /** @brief Méthode qui écrit le journal de la pollinisation pour un génération donnée */
+    /** @brief Méthode qui copie l'état de pollinisation pour le journal (écrit par le thread d'écriture) */
     void writeLogPoll(void);
 
+    /**
+     * @brief
+     * Méthode qui écrit un instantané dans le rapport ou le journal de pollinisation.
+     * Elle est appelée par le thread d'écriture.
+     *
+     * @param snapshot  L'instantané
+     */
+    void writeSnapshot(const WriterSnapshot& snapshot);
+
+    /** @brief Méthode qui écrit la matrice d'apparentement finale (relation_<id>.txt ou relation_<id>.bin) */
     void writeRelatednesses(void);
 
     /**
      * @brief
-     * Méthode qui permet de vider un vecteur et de libérer entièrement la mémoire
+     * Méthode qui écrit la matrice d'apparentement de la génération en cours au format binaire
+     * (voir relatedness_dump.h).
+     *
+     * @param path  Le chemin du fichier
+     */
+    void dumpRelatednesses(const std::string& path);
+
+    /** @brief Méthode appelée à la fin de la simulation (convergence ou dernière génération) */
+    void finish(void);
+
+    /**
+     * @brief
+     * Méthode qui crée les rapports et écrit leur entête (nouvelle simulation).
+     */
+    void openReports(void);
+
+    /** @brief Le chemin de l'instantané du monde */
+    std::string checkpointPath(void) const;
+
+    /**
+     * @brief
+     * Méthode qui écrit l'instantané du monde, au début de la génération genCount.
+     *
+     * L'instantané contient tout ce qu'il faut pour reprendre la simulation à l'identique :
+     * les patchs et leurs populations, l'état de la convergence, les apparentements,
+     * l'état du générateur et la taille atteinte par chaque rapport.
      *
-     * @param toClear   le vecteur à vider, qui doit contenir des doubles
+     * @param done  Si la simulation est terminée (seul l'entête est alors écrit)
      */
-    void clear_and_freeVector(std::vector<double>& toClear);
+    void writeCheckpoint(bool done);
 
     /**
      * @brief
-     * Méthode qui calcule la factorielle de n. Utile pour vérifier la convergence.
+     * Méthode qui reprend le monde à partir de son instantané, s'il existe.
      *
-     * @param n     L'entier dont il faut calculer la factorielle.
+     * Les rapports sont tronqués à la taille qu'ils avaient au moment
+     * de l'instantané, puis rouverts pour y ajouter la suite.
      *
-     * @return      Le résultat (n!).
+     * @return          Vrai si le monde a été repris
      */
-    int factorial(int n);
+    bool readCheckpoint(void);
 };
 
 #endif // WORLD_H_INCLUDED
@@ -0,0 +1,119 @@
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+#include "writer.h"
+
+AsyncWriter::AsyncWriter(void) : head(0), tail(0)
+{
+    stopping = false;
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    stop();
+}
+
+void AsyncWriter::start(int capacity, std::function<void(const WriterSnapshot&)> sink)
+{
+    this->sink = sink;
+
+    slots.resize(capacity > 0 ? capacity : 1);
+
+    if(capacity > 0)
+    {
+        thread = std::thread(&AsyncWriter::loop, this);
+    }
+}
+
+WriterSnapshot& AsyncWriter::acquire(void)
+{
+    std::uint64_t next = tail.load(std::memory_order_relaxed);
+
+    /* La file est pleine : on attend que le thread d'écriture rattrape son retard. */
+    if(thread.joinable() && next - head.load(std::memory_order_acquire) == slots.size())
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&]{ return next - head.load(std::memory_order_acquire) < slots.size(); });
+    }
+
+    return slots[next%slots.size()];
+}
+
+void AsyncWriter::publish(void)
+{
+    if(!thread.joinable())
+    {
+        sink(slots[0]);
+        return;
+    }
+
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    notify();
+}
+
+void AsyncWriter::notify(void)
+{
+    /* Prendre le verrou garantit que l'autre thread n'est pas entre
+    sa vérification et son attente : le réveil ne peut pas être perdu. */
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+
+    changed.notify_all();
+}
+
+void AsyncWriter::loop(void)
+{
+    for(;;)
+    {
+        std::uint64_t next = head.load(std::memory_order_relaxed);
+
+        if(next == tail.load(std::memory_order_acquire))
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]{ return next != tail.load(std::memory_order_acquire) || stopping; });
+
+            if(next == tail.load(std::memory_order_acquire))
+            {
+                return; // Arrêt demandé et plus rien à écrire
+            }
+        }
+
+        sink(slots[next%slots.size()]);
+
+        head.store(next + 1, std::memory_order_release);
+        notify();
+    }
+}
+
+void AsyncWriter::drain(void)
+{
+    if(!thread.joinable())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]{ return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); });
+}
+
+void AsyncWriter::stop(void)
+{
+    if(!thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    changed.notify_all();
+    thread.join();
+}
@@ -0,0 +1,112 @@
+#ifndef WRITER_H_INCLUDED
+#define WRITER_H_INCLUDED
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+#include "summary_report.h"
+
+/**
+ * @file
+ */
+
+/** @brief Énumération du contenu d'un instantané à écrire. */
+typedef enum _snapshotKind_
+{
+    reportSnapshot = 0,     /**< Une génération du rapport */
+    logPollSnapshot = 1,    /**< Une génération du journal de pollinisation */
+} kindSnapshot;
+
+/**
+ * @brief
+ * Structure qui contient une copie compacte de ce qu'il faut écrire pour une génération.
+ * Les vecteurs gardent leur mémoire d'une utilisation à l'autre.
+ */
+typedef struct _WriterSnapshot_
+{
+    kindSnapshot kind; /**< @brief Le contenu de l'instantané */
+    int genCount; /**< @brief La génération */
+    bool last; /**< @brief Si c'est la dernière génération du rapport (il faut le fermer ensuite) */
+    std::vector<int> counts; /**< @brief Le nombre d'individus de chaque patch */
+    std::vector<double> s; /**< @brief Les taux d'autofécondation, patch après patch */
+    std::vector<double> d; /**< @brief Les taux de dispersion, patch après patch */
+    std::vector<TraitSummary> summaries; /**< @brief Avec report=summary, les résumés de s, d puis f de chaque patch (à la place de s et d) */
+    std::vector<int> pollenized; /**< @brief L'état de pollinisation de chaque patch */
+} WriterSnapshot;
+
+/**
+ * @brief
+ * Écrit les rapports dans un thread à part.
+ *
+ * Le thread de la simulation remplit un instantané pré-alloué (acquire), le confie
+ * au thread d'écriture (publish) et continue aussitôt. Les instantanés circulent dans
+ * une file circulaire à un producteur et un consommateur : les positions sont atomiques,
+ * et le verrou ne sert qu'à endormir et réveiller les threads.
+ * Si l'écriture prend du retard, acquire attend qu'un instantané se libère.
+ * Sans thread (capacité nulle), publish écrit directement.
+ */
+
+class AsyncWriter
+{
+public:
+
+    AsyncWriter(void);
+
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    /**
+     * @brief
+     * Méthode qui réserve les instantanés et lance le thread d'écriture.
+     *
+     * @param capacity  Le nombre d'instantanés en attente au plus (0 = écriture directe, sans thread)
+     * @param sink      La fonction qui écrit un instantané
+     */
+    void start(int capacity, std::function<void(const WriterSnapshot&)> sink);
+
+    /**
+     * @brief
+     * Méthode qui renvoie le prochain instantané à remplir,
+     * en attendant qu'il se libère si toute la file est en attente d'écriture.
+     *
+     * @return      L'instantané à remplir
+     */
+    WriterSnapshot& acquire(void);
+
+    /** @brief Méthode qui confie l'instantané rempli au thread d'écriture. */
+    void publish(void);
+
+    /** @brief Méthode qui attend que tous les instantanés confiés soient écrits. */
+    void drain(void);
+
+    /** @brief Méthode qui écrit ce qui reste puis arrête le thread d'écriture. */
+    void stop(void);
+
+private:
+
+    std::vector<WriterSnapshot> slots; /**< @brief Les instantanés, utilisés en file circulaire */
+    std::function<void(const WriterSnapshot&)> sink; /**< @brief La fonction qui écrit un instantané */
+
+    std::atomic<std::uint64_t> head; /**< @brief Le prochain instantané à écrire */
+    std::atomic<std::uint64_t> tail; /**< @brief Le prochain instantané à remplir */
+    bool stopping; /**< @brief Si le thread doit s'arrêter (protégé par mutex) */
+
+    std::mutex mutex; /**< @brief Protège l'attente des deux threads */
+    std::condition_variable changed; /**< @brief Réveille les threads quand head ou tail change */
+    std::thread thread; /**< @brief Le thread d'écriture */
+
+    /** @brief La boucle du thread d'écriture */
+    void loop(void);
+
+    /** @brief Méthode qui réveille l'autre thread après un changement de head ou tail. */
+    void notify(void);
+};
+
+#endif // WRITER_H_INCLUDED